@@ -23,6 +23,12 @@ The application is composed of three sections :
 - Application Task - (code snippet) This is a example which demonstrates the use of Joystick Click board.
      Joystick Click communicates with register via I2C by write and read from register,
      read joystick position and press button state.
+     The work is split into three short tasks run by the driver's cooperative
+     task runner on a 1 ms tick : button debounce, stick sampling and log output,
+     none of them waits, so other tasks can share the main loop.
+     The stick is sampled every 10 ms while it moves, the period doubles
+     while it rests centered, up to 160 ms, which cuts the bus traffic.
+     Events are queued in the driver's event logger and sent one character per tick.
      Results are being sent to the Usart Terminal where you can track their changes.
      All data logs on usb uart when the sensor is triggered.
 
@@ -36,10 +42,51 @@ Additional Functions :
 #include "Click_Joystick_config.h"
 
 
-uint8_t position;
-uint8_t buttonState;
-uint8_t positionOld = 1;
-uint8_t buttonStateOld = 1;
+void sampleTask()
+{
+    int8_t ox;
+    int8_t oy;
+    uint8_t position;
+
+    joystick_readXY( &ox, &oy );
+    joystick_process( &ox, &oy );
+
+    if ( joystick_updatePosition( ox, oy, &position ) )
+    {
+        joystick_logEvent( _JOYSTICK_LOG_POSITION, position );
+    }
+
+    // Next sample in 10 ms while the stick moves, up to 160 ms while it rests
+    joystick_taskSetPeriod( &sampleTask, joystick_updateRate( ox, oy ) );
+}
+
+void buttonTask()
+{
+    T_joystick_buttonEvent event;
+
+    joystick_buttonTick();
+
+    while ( joystick_popButtonEvent( &event ) )
+    {
+        if ( event.type != _JOYSTICK_BUTTON_RELEASE )
+        {
+            joystick_logEvent( _JOYSTICK_LOG_BUTTON, event.type );
+        }
+    }
+}
+
+void logTask()
+{
+    uint8_t character;
+
+    // One character per 1 ms tick is about the 9600 baud line rate,
+    // so the UART hardly ever makes a task wait. joystick_logTxByte() can also be called
+    // from the UART TX empty interrupt instead.
+    if ( joystick_logTxByte( &character ) )
+    {
+        mikrobus_logWrite( &character, _LOG_BYTE );
+    }
+}
 
 void systemInit()
 {
@@ -62,93 +109,32 @@ void applicationInit()
 
     joystick_setDefaultConfiguration();
 
+    // 1 ms ticks : button and log output every tick, stick every 10 .. 160 ms
+    joystick_setButtonTiming( 1000, 10, 800, 300 );
+    joystick_setAdaptiveRate( 10, 160, 4, 8 );
+    joystick_logInit( 0 );
+
+    joystick_taskInit();
+    joystick_taskAdd( &buttonTask, 1, 0 );
+    joystick_taskAdd( &sampleTask, 10, 0 );
+    joystick_taskAdd( &logTask, 1, 0 );
+
     mikrobus_logWrite( "---------------------", _LOG_LINE );
     mikrobus_logWrite( "    Configuration    ", _LOG_LINE );
     mikrobus_logWrite( "---------------------", _LOG_LINE );
     mikrobus_logWrite( "    Joystick Click   ", _LOG_LINE );
     mikrobus_logWrite( "---------------------", _LOG_LINE );
-
-    Delay_100ms();
 }
 
 void applicationTask()
 {
-    buttonState = joystick_pressButton();
-
-    position = joystick_getPosition();
-
-    Delay_10ms();
-
-    if ( buttonState == 1 && buttonStateOld == 0 )
-    {
-        buttonStateOld = 1;
-
-        mikrobus_logWrite( "  Button is pressed ", _LOG_LINE );
-        mikrobus_logWrite( "---------------------", _LOG_LINE );
-    }
+    joystick_taskRun();
 
-    if ( buttonState == 0 && buttonStateOld == 1 )
-    {
-        buttonStateOld = 0;
-    }
-
-    if ( positionOld != position )
-    {
-        switch ( position )
-        {
-            case 0 :
-            {
-                mikrobus_logWrite( "    Start position   ", _LOG_LINE );
-                break;
-            }
-            case 1 :
-            {
-                mikrobus_logWrite( "         Top        ", _LOG_LINE );
-                break;
-            }
-            case 2 :
-            {
-                mikrobus_logWrite( "      Top-Right     ", _LOG_LINE );
-                break;
-            }
-            case 3 :
-            {
-                mikrobus_logWrite( "        Right       ", _LOG_LINE );
-                break;
-            }
-            case 4 :
-            {
-                mikrobus_logWrite( "     Bottom-Right   ", _LOG_LINE );
-                break;
-            }
-            case 5 :
-            {
-                mikrobus_logWrite( "        Bottom      ", _LOG_LINE );
-                break;
-            }
-            case 6 :
-            {
-                mikrobus_logWrite( "     Bottom-Left    ", _LOG_LINE );
-                break;
-            }
-            case 7 :
-            {
-                mikrobus_logWrite( "         Left       ", _LOG_LINE );
-                break;
-            }
-            case 8 :
-            {
-                mikrobus_logWrite( "       Top-Left     ", _LOG_LINE );
-                break;
-            }
-        }
-
-        mikrobus_logWrite( "---------------------", _LOG_LINE );
-
-        positionOld = position;
-
-        Delay_100ms();
-    }
+    // Idle time base of the task runner, other tasks of the application go
+    // into spare runner slots. With a 1 ms timer interrupt calling
+    // joystick_taskTick() this delay and the call below are removed.
+    Delay_1ms();
+    joystick_taskTick();
 }
 
 void main()
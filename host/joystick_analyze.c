@@ -0,0 +1,494 @@
+/*
+Joystick Click capture corpus analyzer
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX threads, mmap )
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -pthread -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_analyze.c -o joystick_analyze -lm
+
+---
+
+Description :
+
+Runs the driver's calibration, filter and direction tracker over any number
+of capture files ( joystick_capture.h, one file per unit ) on all cores and
+reports per unit :
+
+- samples and gaps,
+- rest share ( raw X and Y inside the low threshold ) and dead zone hits,
+- jitter, RMS of the processed sample to sample change while at rest,
+- drift, least squares slope of the raw rest position in counts per hour,
+- direction histogram and number of direction changes.
+
+- joystick_analyze [options] unit1.jcap unit2.jcap ...
+
+| Option            | Default       | Meaning                                                   |
+|:-----------------:|:-------------:|:----------------------------------------------------------|
+| -j threads        | online CPUs   | worker threads                                            |
+| -s records        | 65536         | segment size, 0 processes every file as one segment       |
+| -w records        | 1024          | warm-up records run before a segment, not counted         |
+| -t low,high       | 20,60         | joystick_setThresholds()                                  |
+| -d radius,hyst    | 20,4          | joystick_setDeadzone()                                    |
+| -f type,p1,p2     | 0             | joystick_setFilter()                                      |
+| -l                | off           | learn calibration ( _JOYSTICK_CALIBRATION_LEARN )         |
+
+Files are cut into segments which the workers take from their own deque
+and steal from the others' when it runs dry, so a few long captures spread
+over all cores as well as many short ones. Every segment runs a copy of
+one driver context configured by the options, through the same
+joystick_ctx* functions as the firmware, and results are merged per file
+in segment order, so the report does not depend on the thread count.
+
+Each segment starts with fresh filter and tracker state primed by the
+warm-up records. Without a filter or with a median filter that state has
+settled once the stick leaves the hysteresis band of a zone border, so the
+results match one pass over the file unless the stick rests on a border
+for longer than the warm-up. The IIR and adaptive filters and calibration
+learning have a longer memory, use -s 0 when the output must match the
+firmware bit for bit.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "joystick_capture.h"
+#include "__joystick_driver.c"
+
+/* Work item, records [ first, end ) of one file */
+typedef struct
+{
+    uint32_t            file;
+    uint64_t            first;
+    uint64_t            end;
+
+}T_task;
+
+/* Per segment result, merged per file */
+typedef struct
+{
+    uint64_t            samples;
+    uint64_t            gaps;
+    uint64_t            rest;
+    uint64_t            deadzone;
+    uint64_t            changes;
+    uint64_t            histogram[ 9 ];
+    uint64_t            jitterN;
+    double              jitterXX;
+    double              jitterYY;
+    double              n;
+    double              st;
+    double              stt;
+    double              sx;
+    double              sy;
+    double              stx;
+    double              sty;
+
+}T_result;
+
+/* Worker deque, the owner pops from the bottom and thieves take from the top */
+typedef struct
+{
+    pthread_mutex_t     lock;
+    uint32_t            *tasks;
+    uint32_t            top;
+    uint32_t            bottom;
+    uint32_t            done;
+    uint32_t            stolen;
+
+}T_deque;
+
+static T_joystick_capFile   *files;
+static T_task               *tasks;
+static T_result             *results;
+static T_deque              *deques;
+static uint32_t             nWorkers;
+static uint64_t             warmup;
+static T_joystick_ctx       templateCtx;
+
+static const char *directionName[ 9 ] =
+{
+    "start", "T", "TR", "R", "BR", "B", "BL", "L", "TL"
+};
+
+static void runTask( const T_task *task, T_result *r )
+{
+    const T_joystick_capFile *f;
+    const T_joystick_capRecord *rec;
+    T_joystick_ctx ctx;
+    uint64_t from;
+    uint64_t i;
+    uint32_t chunk;
+    uint8_t position;
+    uint8_t changed;
+    uint8_t rest;
+    uint8_t prevRest;
+    int8_t prevX;
+    int8_t prevY;
+    int8_t ox;
+    int8_t oy;
+    int16_t low;
+    double t;
+    double dx;
+    double dy;
+
+    f = &files[ task->file ];
+    ctx = templateCtx;
+    low = ctx.lowThreshold;
+
+    memset( r, 0, sizeof( *r ) );
+
+    from = task->first > warmup ? task->first - warmup : 0;
+    chunk = joystick_capChunkOf( f, from );
+    prevRest = 0;
+    prevX = 0;
+    prevY = 0;
+
+    for ( i = from; i < task->end; i++ )
+    {
+        if ( chunk + 1 < f->chunks && i >= f->index[ chunk + 1 ].firstRecord )
+            chunk++;
+
+        rec = &f->records[ i ];
+        ox = rec->x;
+        oy = rec->y;
+        rest = ox < low && ox > -low && oy < low && oy > -low;
+
+        // a lost stretch breaks the jitter pair
+        if ( rec->flags & _JOYSTICK_CAP_FLAG_GAP )
+            prevRest = 0;
+
+        if ( i >= task->first && rest )
+        {
+            t = ( joystick_capTime( f, chunk, i ) - f->index[ 0 ].baseUs ) * 1e-6;
+
+            r->n += 1.0;
+            r->st += t;
+            r->stt += t * t;
+            r->sx += ox;
+            r->sy += oy;
+            r->stx += t * ox;
+            r->sty += t * oy;
+        }
+
+        joystick_ctxProcess( &ctx, &ox, &oy );
+        changed = joystick_ctxUpdatePosition( &ctx, ox, oy, &position );
+
+        if ( i >= task->first )
+        {
+            r->samples++;
+            r->gaps += rec->flags & _JOYSTICK_CAP_FLAG_GAP;
+            r->rest += rest;
+            r->deadzone += ctx.inDeadzone;
+            r->changes += changed;
+            r->histogram[ ctx.lastPosition ]++;
+
+            if ( rest && prevRest )
+            {
+                dx = ox - prevX;
+                dy = oy - prevY;
+                r->jitterXX += dx * dx;
+                r->jitterYY += dy * dy;
+                r->jitterN++;
+            }
+        }
+
+        prevRest = rest;
+        prevX = ox;
+        prevY = oy;
+    }
+}
+
+static uint8_t popTask( uint32_t self, uint32_t *task )
+{
+    T_deque *q;
+    uint32_t k;
+    uint8_t found;
+
+    q = &deques[ self ];
+    pthread_mutex_lock( &q->lock );
+    found = q->bottom > q->top;
+
+    if ( found )
+        *task = q->tasks[ --q->bottom ];
+
+    pthread_mutex_unlock( &q->lock );
+
+    if ( found )
+        return 1;
+
+    // tasks are never added while running, so empty deques everywhere means done
+    for ( k = 1; k < nWorkers && !found; k++ )
+    {
+        q = &deques[ ( self + k ) % nWorkers ];
+        pthread_mutex_lock( &q->lock );
+        found = q->bottom > q->top;
+
+        if ( found )
+            *task = q->tasks[ q->top++ ];
+
+        pthread_mutex_unlock( &q->lock );
+    }
+
+    if ( found )
+        deques[ self ].stolen++;
+
+    return found;
+}
+
+static void *worker( void *arg )
+{
+    uint32_t self;
+    uint32_t task;
+
+    self = (uint32_t)(uintptr_t)arg;
+
+    while ( popTask( self, &task ) )
+    {
+        runTask( &tasks[ task ], &results[ task ] );
+        deques[ self ].done++;
+    }
+
+    return 0;
+}
+
+static void merge( T_result *dst, const T_result *src )
+{
+    uint8_t i;
+
+    dst->samples += src->samples;
+    dst->gaps += src->gaps;
+    dst->rest += src->rest;
+    dst->deadzone += src->deadzone;
+    dst->changes += src->changes;
+    dst->jitterN += src->jitterN;
+    dst->jitterXX += src->jitterXX;
+    dst->jitterYY += src->jitterYY;
+    dst->n += src->n;
+    dst->st += src->st;
+    dst->stt += src->stt;
+    dst->sx += src->sx;
+    dst->sy += src->sy;
+    dst->stx += src->stx;
+    dst->sty += src->sty;
+
+    for ( i = 0; i < 9; i++ )
+        dst->histogram[ i ] += src->histogram[ i ];
+}
+
+static void report( const char *name, const T_result *r )
+{
+    double samples;
+    double den;
+    double driftX;
+    double driftY;
+    uint8_t i;
+
+    samples = r->samples ? (double)r->samples : 1.0;
+    den = r->n * r->stt - r->st * r->st;
+    driftX = 0.0;
+    driftY = 0.0;
+
+    // slope in counts per second, reported per hour
+    if ( r->n > 1.0 && den > 0.0 )
+    {
+        driftX = 3600.0 * ( r->n * r->stx - r->st * r->sx ) / den;
+        driftY = 3600.0 * ( r->n * r->sty - r->st * r->sy ) / den;
+    }
+
+    printf( "%s\n", name );
+    printf( "    samples %llu, gaps %llu, rest %.1f %%, dead zone %.1f %%, direction changes %llu\n",
+            (unsigned long long)r->samples, (unsigned long long)r->gaps,
+            100.0 * r->rest / samples, 100.0 * r->deadzone / samples, (unsigned long long)r->changes );
+    printf( "    jitter x %.3f y %.3f, rest center x %.2f y %.2f, drift x %+.3f y %+.3f per hour\n",
+            r->jitterN ? sqrt( r->jitterXX / r->jitterN ) : 0.0, r->jitterN ? sqrt( r->jitterYY / r->jitterN ) : 0.0,
+            r->n > 0.0 ? r->sx / r->n : 0.0, r->n > 0.0 ? r->sy / r->n : 0.0, driftX, driftY );
+    printf( "   " );
+
+    for ( i = 0; i < 9; i++ )
+        printf( " %s %.1f%%", directionName[ i ], 100.0 * r->histogram[ i ] / samples );
+
+    printf( "\n" );
+}
+
+static uint8_t parsePair( const char *arg, uint8_t *a, uint8_t *b )
+{
+    unsigned va;
+    unsigned vb;
+
+    vb = *b;
+
+    if ( sscanf( arg, "%u,%u", &va, &vb ) < 1 || va > 255 || vb > 255 )
+        return 0;
+
+    *a = (uint8_t)va;
+    *b = (uint8_t)vb;
+
+    return 1;
+}
+
+int main( int argc, char **argv )
+{
+    T_hal_simBus bus;
+    T_hal_simDevice dev;
+    T_hal_gpioObj gpio;
+    T_result total;
+    T_result unit;
+    pthread_t *threads;
+    struct timespec t0;
+    struct timespec t1;
+    uint64_t segment;
+    uint64_t first;
+    uint32_t nFiles;
+    uint32_t nTasks;
+    uint32_t i;
+    uint32_t k;
+    unsigned filter[ 3 ];
+    uint8_t low;
+    uint8_t high;
+    uint8_t radius;
+    uint8_t hysteresis;
+    uint8_t learn;
+    double seconds;
+    int c;
+
+    nWorkers = (uint32_t)sysconf( _SC_NPROCESSORS_ONLN );
+    segment = 65536;
+    warmup = 1024;
+    low = _JOYSTICK_DEFAULT_LOW_THRESHOLD;
+    high = _JOYSTICK_DEFAULT_HIGH_THRESHOLD;
+    radius = _JOYSTICK_DEFAULT_LOW_THRESHOLD;
+    hysteresis = _JOYSTICK_DEFAULT_HYSTERESIS;
+    filter[ 0 ] = 0;
+    filter[ 1 ] = 0;
+    filter[ 2 ] = 0;
+    learn = 0;
+
+    while ( ( c = getopt( argc, argv, "j:s:w:t:d:f:l" ) ) != -1 )
+    {
+        if ( c == 'j' )
+            nWorkers = (uint32_t)atoi( optarg );
+        else if ( c == 's' )
+            segment = strtoull( optarg, 0, 10 );
+        else if ( c == 'w' )
+            warmup = strtoull( optarg, 0, 10 );
+        else if ( c == 't' && parsePair( optarg, &low, &high ) )
+            continue;
+        else if ( c == 'd' && parsePair( optarg, &radius, &hysteresis ) )
+            continue;
+        else if ( c == 'f' && sscanf( optarg, "%u,%u,%u", &filter[ 0 ], &filter[ 1 ], &filter[ 2 ] ) >= 1 )
+            continue;
+        else if ( c == 'l' )
+            learn = 1;
+        else
+            optind = argc + 1;
+    }
+
+    if ( optind >= argc || !nWorkers )
+    {
+        fprintf( stderr, "usage : %s [-j threads] [-s segment] [-w warmup] [-t low,high] [-d radius,hyst] [-f type,p1,p2] [-l] unit.jcap ...\n", argv[ 0 ] );
+        return 1;
+    }
+
+    // driver context configured once, copied by every segment
+    hal_simBusInit( &bus, 400000 );
+    hal_simDeviceInit( &dev, _JOYSTICK_I2C_ADDRESS_0, 0, 0, 0 );
+    hal_simBusAttach( &bus, &dev );
+    hal_simGpioObj( &gpio, 0, &dev );
+
+    joystick_ctxI2cDriverInit( &templateCtx, (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, _JOYSTICK_I2C_ADDRESS_0 );
+    joystick_ctxSetThresholds( &templateCtx, low, high );
+    joystick_ctxSetDeadzone( &templateCtx, radius, hysteresis );
+    joystick_ctxSetFilter( &templateCtx, (uint8_t)filter[ 0 ], (uint8_t)filter[ 1 ], (uint8_t)filter[ 2 ] );
+    joystick_ctxSetCalibrationMode( &templateCtx, learn ? _JOYSTICK_CALIBRATION_LEARN : _JOYSTICK_CALIBRATION_OFF );
+
+    nFiles = (uint32_t)( argc - optind );
+    files = (T_joystick_capFile*)calloc( nFiles, sizeof( T_joystick_capFile ) );
+    nTasks = 0;
+
+    for ( i = 0; i < nFiles; i++ )
+    {
+        if ( joystick_capOpen( &files[ i ], argv[ optind + i ] ) )
+        {
+            fprintf( stderr, "%s : not a capture file\n", argv[ optind + i ] );
+            return 1;
+        }
+
+        nTasks += segment ? (uint32_t)( ( files[ i ].count + segment - 1 ) / segment ) : 1;
+    }
+
+    tasks = (T_task*)calloc( nTasks ? nTasks : 1, sizeof( T_task ) );
+    results = (T_result*)calloc( nTasks ? nTasks : 1, sizeof( T_result ) );
+    deques = (T_deque*)calloc( nWorkers, sizeof( T_deque ) );
+    threads = (pthread_t*)calloc( nWorkers, sizeof( pthread_t ) );
+
+    for ( k = 0, i = 0; i < nFiles; i++ )
+    {
+        for ( first = 0; first < files[ i ].count; first += segment )
+        {
+            tasks[ k ].file = i;
+            tasks[ k ].first = first;
+            tasks[ k ].end = segment && files[ i ].count - first > segment ? first + segment : files[ i ].count;
+            k++;
+
+            if ( !segment )
+                break;
+        }
+    }
+
+    nTasks = k;
+
+    // contiguous runs per worker, owners walk back from the end of theirs
+    for ( i = 0; i < nWorkers; i++ )
+    {
+        pthread_mutex_init( &deques[ i ].lock, 0 );
+        deques[ i ].tasks = (uint32_t*)calloc( nTasks + 1, sizeof( uint32_t ) );
+
+        for ( k = (uint32_t)( (uint64_t)nTasks * i / nWorkers ); k < (uint64_t)nTasks * ( i + 1 ) / nWorkers; k++ )
+            deques[ i ].tasks[ deques[ i ].bottom++ ] = k;
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+
+    for ( i = 0; i < nWorkers; i++ )
+        pthread_create( &threads[ i ], 0, worker, (void*)(uintptr_t)i );
+
+    for ( i = 0; i < nWorkers; i++ )
+        pthread_join( threads[ i ], 0 );
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    seconds = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) * 1e-9;
+
+    memset( &total, 0, sizeof( total ) );
+
+    for ( k = 0, i = 0; i < nFiles; i++ )
+    {
+        memset( &unit, 0, sizeof( unit ) );
+
+        for ( ; k < nTasks && tasks[ k ].file == i; k++ )
+            merge( &unit, &results[ k ] );
+
+        report( argv[ optind + i ], &unit );
+        merge( &total, &unit );
+        joystick_capClose( &files[ i ] );
+    }
+
+    fprintf( stderr, "\n%u files, %llu samples, %u segments, %u threads, %.3f s, %.1f M samples/s\n",
+             nFiles, (unsigned long long)total.samples, nTasks, nWorkers, seconds,
+             seconds > 0.0 ? total.samples / seconds * 1e-6 : 0.0 );
+
+    for ( i = 0; i < nWorkers; i++ )
+        fprintf( stderr, "    thread %u : %u segments, %u stolen\n", i, deques[ i ].done, deques[ i ].stolen );
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+Joystick Click capture file tool
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -D__JOYSTICK_TELEMETRY__ -I../library -I../library/HAL joystick_capture.c -o joystick_capture
+
+---
+
+Description :
+
+Converts the driver's binary telemetry stream into the indexed capture
+format of joystick_capture.h, and reads captures through mmap.
+
+- joystick_capture convert stream.bin capture.jcap        - decode telemetry ( "-" for stdin ) into a capture file
+- joystick_capture info capture.jcap                      - record count, chunks, time span
+- joystick_capture window capture.jcap fromUs toUs        - print the samples in [ fromUs, toUs ) as CSV
+
+Telemetry timestamps are 32-bit microseconds, the converter extends them
+to 64 bits so captures may span hours. Samples lost in the stream are
+marked with _JOYSTICK_CAP_FLAG_GAP on the next sample.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "joystick_capture.h"
+#include "__joystick_driver.c"
+
+static int convert( const char *inPath, const char *outPath )
+{
+    T_joystick_telemetryDecoder dec;
+    T_joystick_record record;
+    T_joystick_capWriter w;
+    FILE *in;
+    uint64_t high;
+    uint32_t last;
+    uint32_t lost;
+    uint8_t flags;
+    int first;
+    int c;
+
+    in = strcmp( inPath, "-" ) ? fopen( inPath, "rb" ) : stdin;
+
+    if ( !in )
+    {
+        perror( inPath );
+        return 1;
+    }
+
+    if ( joystick_capCreate( &w, outPath, 0 ) )
+    {
+        perror( outPath );
+        return 1;
+    }
+
+    joystick_telemetryDecoderInit( &dec );
+
+    high = 0;
+    last = 0;
+    lost = 0;
+    first = 1;
+
+    while ( ( c = getc( in ) ) != EOF )
+    {
+        if ( !joystick_telemetryDecode( &dec, (uint8_t)c, &record ) )
+            continue;
+
+        // 32-bit device time wrapped
+        if ( !first && record.timestamp < last )
+            high += 0x100000000ull;
+
+        flags = dec.lost != lost ? _JOYSTICK_CAP_FLAG_GAP : 0;
+        lost = dec.lost;
+        last = record.timestamp;
+        first = 0;
+
+        if ( joystick_capAppend( &w, high + record.timestamp, record.x, record.y, record.button, flags ) )
+        {
+            perror( outPath );
+            return 1;
+        }
+    }
+
+    if ( in != stdin )
+        fclose( in );
+
+    fprintf( stderr, "%lu frames, %lu bad, %lu lost, %llu records in %lu chunks\n",
+             (unsigned long)dec.frames, (unsigned long)dec.crcErrors, (unsigned long)dec.lost,
+             (unsigned long long)w.count, (unsigned long)w.chunks );
+
+    if ( joystick_capFinish( &w ) )
+    {
+        perror( outPath );
+        return 1;
+    }
+
+    return 0;
+}
+
+static int info( const T_joystick_capFile *f )
+{
+    uint64_t gaps;
+    uint64_t i;
+
+    printf( "%llu records, %lu chunks\n", (unsigned long long)f->count, (unsigned long)f->chunks );
+
+    if ( f->chunks )
+        printf( "time %llu .. %llu us\n", (unsigned long long)f->index[ 0 ].baseUs,
+                (unsigned long long)f->index[ f->chunks - 1 ].lastUs );
+
+    // the only full scan, touches every page
+    for ( gaps = 0, i = 0; i < f->count; i++ )
+        gaps += f->records[ i ].flags & _JOYSTICK_CAP_FLAG_GAP;
+
+    printf( "%llu gaps\n", (unsigned long long)gaps );
+
+    return 0;
+}
+
+static int window( const T_joystick_capFile *f, uint64_t fromUs, uint64_t toUs )
+{
+    uint64_t i;
+    uint64_t t;
+    uint32_t chunk;
+
+    i = joystick_capSeek( f, fromUs );
+
+    if ( i >= f->count )
+        return 0;
+
+    chunk = joystick_capChunkOf( f, i );
+
+    printf( "timestamp_us,x,y,button,flags\n" );
+
+    for ( ; i < f->count; i++ )
+    {
+        if ( chunk + 1 < f->chunks && i >= f->index[ chunk + 1 ].firstRecord )
+            chunk++;
+
+        t = joystick_capTime( f, chunk, i );
+
+        if ( t >= toUs )
+            break;
+
+        printf( "%llu,%d,%d,%u,%u\n", (unsigned long long)t, f->records[ i ].x, f->records[ i ].y,
+                f->records[ i ].button, f->records[ i ].flags );
+    }
+
+    return 0;
+}
+
+int main( int argc, char **argv )
+{
+    T_joystick_capFile f;
+    int ret;
+
+    if ( argc == 4 && !strcmp( argv[ 1 ], "convert" ) )
+        return convert( argv[ 2 ], argv[ 3 ] );
+
+    if ( ( argc == 3 && !strcmp( argv[ 1 ], "info" ) ) || ( argc == 5 && !strcmp( argv[ 1 ], "window" ) ) )
+    {
+        if ( joystick_capOpen( &f, argv[ 2 ] ) )
+        {
+            fprintf( stderr, "%s : not a capture file\n", argv[ 2 ] );
+            return 1;
+        }
+
+        if ( argc == 3 )
+            ret = info( &f );
+        else
+            ret = window( &f, strtoull( argv[ 3 ], 0, 10 ), strtoull( argv[ 4 ], 0, 10 ) );
+
+        joystick_capClose( &f );
+
+        return ret;
+    }
+
+    fprintf( stderr, "usage : %s convert stream.bin capture.jcap | info capture.jcap | window capture.jcap fromUs toUs\n", argv[ 0 ] );
+
+    return 1;
+}
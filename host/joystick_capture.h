@@ -0,0 +1,372 @@
+/*
+Joystick Click capture file format
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX mmap )
+    Compiler         : gcc / clang ( C99 )
+
+---
+
+Description :
+
+Indexed sample file for long captures, read through mmap so that opening
+a file costs a few page faults whatever its size, and reading a time
+window touches only the index and the pages of that window.
+
+Layout, all fields little endian :
+
+| Part     | Size            | Content                                                        |
+|:--------:|:---------------:|:---------------------------------------------------------------|
+| header   | 64              | "JCAP", version, record size, records per chunk               |
+| records  | 8 * count       | T_joystick_capRecord, grouped in chunks                        |
+| index    | 32 * chunks     | T_joystick_capIndex, one per chunk, ordered by time            |
+| trailer  | 32              | "JIDX", index offset, record count, chunk count               |
+
+A chunk holds up to chunkRecords samples, a record stores its time as the
+offset in microseconds from the chunk base time, so a new chunk is also
+started when that offset would not fit 32 bits.
+
+The header is shared by the host tools, which define _POSIX_C_SOURCE 200809L
+and _FILE_OFFSET_BITS 64 before including any system header.
+
+*/
+
+#ifndef _JOYSTICK_CAPTURE_H_
+#define _JOYSTICK_CAPTURE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define _JOYSTICK_CAP_VERSION           1
+#define _JOYSTICK_CAP_HEADER_SIZE       64
+#define _JOYSTICK_CAP_TRAILER_SIZE      32
+#define _JOYSTICK_CAP_CHUNK_RECORDS     4096
+
+/** Record flag : samples were lost right before this one */
+#define _JOYSTICK_CAP_FLAG_GAP          0x01
+
+/** Sample record, 8 bytes */
+typedef struct
+{
+    uint32_t        offsetUs;
+    int8_t          x;
+    int8_t          y;
+    uint8_t         button;
+    uint8_t         flags;
+
+}T_joystick_capRecord;
+
+/** Chunk index entry, 32 bytes */
+typedef struct
+{
+    uint64_t        baseUs;
+    uint64_t        lastUs;
+    uint64_t        firstRecord;
+    uint32_t        count;
+    uint32_t        reserved;
+
+}T_joystick_capIndex;
+
+/** Open capture file, mapped read only */
+typedef struct
+{
+    const uint8_t               *map;
+    size_t                      size;
+    const T_joystick_capRecord  *records;
+    const T_joystick_capIndex   *index;
+    uint64_t                    count;
+    uint32_t                    chunks;
+
+}T_joystick_capFile;
+
+/** Capture file being written */
+typedef struct
+{
+    FILE                        *file;
+    T_joystick_capIndex         *index;
+    uint32_t                    chunks;
+    uint32_t                    capacity;
+    uint64_t                    count;
+    uint32_t                    chunkRecords;
+
+}T_joystick_capWriter;
+
+/* ------------------------------------------------------------------- WRITER */
+
+static inline void joystick_capPut32( uint8_t *p, uint32_t v )
+{
+    p[ 0 ] = (uint8_t)v;
+    p[ 1 ] = (uint8_t)( v >> 8 );
+    p[ 2 ] = (uint8_t)( v >> 16 );
+    p[ 3 ] = (uint8_t)( v >> 24 );
+}
+
+static inline void joystick_capPut64( uint8_t *p, uint64_t v )
+{
+    joystick_capPut32( p, (uint32_t)v );
+    joystick_capPut32( p + 4, (uint32_t)( v >> 32 ) );
+}
+
+/** Create capture file, chunkRecords 0 selects _JOYSTICK_CAP_CHUNK_RECORDS. Returns 0 on success. */
+static inline int joystick_capCreate( T_joystick_capWriter *w, const char *path, uint32_t chunkRecords )
+{
+    uint8_t header[ _JOYSTICK_CAP_HEADER_SIZE ];
+
+    memset( w, 0, sizeof( *w ) );
+    w->chunkRecords = chunkRecords ? chunkRecords : _JOYSTICK_CAP_CHUNK_RECORDS;
+    w->file = fopen( path, "wb" );
+
+    if ( !w->file )
+        return 1;
+
+    memset( header, 0, sizeof( header ) );
+    memcpy( header, "JCAP", 4 );
+    header[ 4 ] = _JOYSTICK_CAP_VERSION;
+    header[ 6 ] = sizeof( T_joystick_capRecord );
+    joystick_capPut32( &header[ 8 ], w->chunkRecords );
+
+    return fwrite( header, 1, sizeof( header ), w->file ) != sizeof( header );
+}
+
+/** Append sample at absolute time timeUs, a time before the previous one is raised to it. Returns 0 on success. */
+static inline int joystick_capAppend( T_joystick_capWriter *w, uint64_t timeUs, int8_t x, int8_t y, uint8_t button, uint8_t flags )
+{
+    T_joystick_capIndex *chunk;
+    uint8_t rec[ 8 ];
+
+    chunk = w->chunks ? &w->index[ w->chunks - 1 ] : 0;
+
+    // keep the file sorted by time, seeking relies on it
+    if ( chunk && timeUs < chunk->lastUs )
+        timeUs = chunk->lastUs;
+
+    if ( !chunk || chunk->count >= w->chunkRecords || timeUs - chunk->baseUs > 0xFFFFFFFFu )
+    {
+        if ( w->chunks == w->capacity )
+        {
+            T_joystick_capIndex *grown;
+
+            w->capacity = w->capacity ? 2 * w->capacity : 64;
+            grown = (T_joystick_capIndex*)realloc( w->index, w->capacity * sizeof( T_joystick_capIndex ) );
+
+            if ( !grown )
+                return 1;
+
+            w->index = grown;
+        }
+
+        chunk = &w->index[ w->chunks++ ];
+        chunk->baseUs = timeUs;
+        chunk->lastUs = timeUs;
+        chunk->firstRecord = w->count;
+        chunk->count = 0;
+        chunk->reserved = 0;
+    }
+
+    joystick_capPut32( rec, (uint32_t)( timeUs - chunk->baseUs ) );
+    rec[ 4 ] = (uint8_t)x;
+    rec[ 5 ] = (uint8_t)y;
+    rec[ 6 ] = button;
+    rec[ 7 ] = flags;
+
+    chunk->lastUs = timeUs;
+    chunk->count++;
+    w->count++;
+
+    return fwrite( rec, 1, sizeof( rec ), w->file ) != sizeof( rec );
+}
+
+/** Write index and trailer and close. Returns 0 on success. */
+static inline int joystick_capFinish( T_joystick_capWriter *w )
+{
+    uint8_t entry[ 32 ];
+    uint8_t trailer[ _JOYSTICK_CAP_TRAILER_SIZE ];
+    uint64_t indexOffset;
+    uint32_t i;
+    int err;
+
+    err = 0;
+    indexOffset = _JOYSTICK_CAP_HEADER_SIZE + w->count * sizeof( T_joystick_capRecord );
+
+    for ( i = 0; i < w->chunks && !err; i++ )
+    {
+        joystick_capPut64( &entry[ 0 ], w->index[ i ].baseUs );
+        joystick_capPut64( &entry[ 8 ], w->index[ i ].lastUs );
+        joystick_capPut64( &entry[ 16 ], w->index[ i ].firstRecord );
+        joystick_capPut32( &entry[ 24 ], w->index[ i ].count );
+        joystick_capPut32( &entry[ 28 ], 0 );
+        err = fwrite( entry, 1, sizeof( entry ), w->file ) != sizeof( entry );
+    }
+
+    memset( trailer, 0, sizeof( trailer ) );
+    memcpy( trailer, "JIDX", 4 );
+    joystick_capPut64( &trailer[ 8 ], indexOffset );
+    joystick_capPut64( &trailer[ 16 ], w->count );
+    joystick_capPut32( &trailer[ 24 ], w->chunks );
+
+    if ( !err )
+        err = fwrite( trailer, 1, sizeof( trailer ), w->file ) != sizeof( trailer );
+
+    if ( fclose( w->file ) )
+        err = 1;
+
+    free( w->index );
+    w->index = 0;
+    w->file = 0;
+
+    return err;
+}
+
+/* ------------------------------------------------------------------- READER */
+
+/*
+ * The reader casts the mapped bytes to the record and index types,
+ * which matches the little endian layout on x86 and ARM Linux hosts.
+ */
+
+/** Map capture file and check header and trailer. Returns 0 on success. */
+static inline int joystick_capOpen( T_joystick_capFile *f, const char *path )
+{
+    struct stat st;
+    const uint8_t *t;
+    uint64_t indexOffset;
+    int fd;
+
+    memset( f, 0, sizeof( *f ) );
+
+    fd = open( path, O_RDONLY );
+
+    if ( fd < 0 )
+        return 1;
+
+    if ( fstat( fd, &st ) || st.st_size < _JOYSTICK_CAP_HEADER_SIZE + _JOYSTICK_CAP_TRAILER_SIZE )
+    {
+        close( fd );
+        return 1;
+    }
+
+    f->size = (size_t)st.st_size;
+    f->map = (const uint8_t*)mmap( 0, f->size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+
+    if ( f->map == (const uint8_t*)MAP_FAILED )
+    {
+        f->map = 0;
+        return 1;
+    }
+
+    t = f->map + f->size - _JOYSTICK_CAP_TRAILER_SIZE;
+    memcpy( &indexOffset, t + 8, 8 );
+    memcpy( &f->count, t + 16, 8 );
+    memcpy( &f->chunks, t + 24, 4 );
+
+    if ( memcmp( f->map, "JCAP", 4 ) || f->map[ 4 ] != _JOYSTICK_CAP_VERSION ||
+         f->map[ 6 ] != sizeof( T_joystick_capRecord ) || memcmp( t, "JIDX", 4 ) ||
+         indexOffset != _JOYSTICK_CAP_HEADER_SIZE + f->count * sizeof( T_joystick_capRecord ) ||
+         indexOffset + (uint64_t)f->chunks * sizeof( T_joystick_capIndex ) + _JOYSTICK_CAP_TRAILER_SIZE != f->size )
+    {
+        munmap( (void*)f->map, f->size );
+        f->map = 0;
+        return 1;
+    }
+
+    f->records = (const T_joystick_capRecord*)( f->map + _JOYSTICK_CAP_HEADER_SIZE );
+    f->index = (const T_joystick_capIndex*)( f->map + indexOffset );
+
+    // no readahead, a window read faults in only its own pages
+    posix_madvise( (void*)f->map, f->size, POSIX_MADV_RANDOM );
+
+    return 0;
+}
+
+static inline void joystick_capClose( T_joystick_capFile *f )
+{
+    if ( f->map )
+        munmap( (void*)f->map, f->size );
+
+    f->map = 0;
+}
+
+/** Chunk holding record i */
+static inline uint32_t joystick_capChunkOf( const T_joystick_capFile *f, uint64_t i )
+{
+    uint32_t lo = 0;
+    uint32_t hi = f->chunks;
+
+    while ( hi - lo > 1 )
+    {
+        uint32_t mid = lo + ( hi - lo ) / 2;
+
+        if ( f->index[ mid ].firstRecord <= i )
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/** Absolute time of record i, chunk is its chunk from joystick_capChunkOf() */
+static inline uint64_t joystick_capTime( const T_joystick_capFile *f, uint32_t chunk, uint64_t i )
+{
+    return f->index[ chunk ].baseUs + f->records[ i ].offsetUs;
+}
+
+/** First record at or after timeUs, count when there is none */
+static inline uint64_t joystick_capSeek( const T_joystick_capFile *f, uint64_t timeUs )
+{
+    const T_joystick_capIndex *c;
+    uint32_t lo;
+    uint32_t hi;
+    uint64_t a;
+    uint64_t b;
+
+    // first chunk ending at or after timeUs
+    lo = 0;
+    hi = f->chunks;
+
+    while ( lo < hi )
+    {
+        uint32_t mid = lo + ( hi - lo ) / 2;
+
+        if ( f->index[ mid ].lastUs < timeUs )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if ( lo == f->chunks )
+        return f->count;
+
+    c = &f->index[ lo ];
+
+    if ( timeUs <= c->baseUs )
+        return c->firstRecord;
+
+    // inside the chunk the offsets are sorted
+    a = c->firstRecord;
+    b = c->firstRecord + c->count;
+
+    while ( a < b )
+    {
+        uint64_t mid = a + ( b - a ) / 2;
+
+        if ( c->baseUs + f->records[ mid ].offsetUs < timeUs )
+            a = mid + 1;
+        else
+            b = mid;
+    }
+
+    return a;
+}
+
+#endif
@@ -0,0 +1,382 @@
+/*
+Joystick Click event daemon
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( epoll, GPIO character device )
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_LINUX__ -I../library -I../library/HAL joystick_daemon.c -o joystick_daemon -lrt
+
+---
+
+Description :
+
+Sleeps in epoll_wait() until the AS5013 pulls INT low, then reads the new
+measurement and publishes it, so the process uses no CPU while the stick
+is idle and a sample is out one scheduler wakeup after the edge.
+
+- joystick_daemon [-p /name] [-c file] [-b line] /dev/i2c-1 /dev/gpiochip0 line [address]  - click on the adapter, INT on line of the GPIO chip
+- joystick_daemon [-p /name] [-c file] - [periodMs] [samples]                                - stand-in adapter measuring every periodMs ( default 10 ), stop after samples
+
+-b reads the button ( CS ) pin from line of the same GPIO chip. -c loads
+the calibration blob of file ( _JOYSTICK_CALIBRATION_SIZE bytes from
+joystick_getCalibration() ) and applies it to every sample, without it X
+and Y are not calibrated.
+
+Every edge runs joystick_isrHandler() : one burst read of X and Y, which
+also releases INT, and the button level, into the driver's event ring.
+An edge arriving while INT is already low is not reported again, so the
+handler is repeated while joystick_getInterrupt() still reads low.
+The ring is then drained through joystick_process() and the direction
+tracker, and each sample is published on stdout :
+
+    timestamp_us x y button position
+
+( the button column only with -b, without a button line its level is
+unknown ) or, with -p, as the latest state in the shared-memory segment /name
+( joystick_shm.h ) for any number of local readers.
+
+In stand-in mode the INT line is an eventfd written by a timerfd playing
+the measurement clock of the chip ( joystick_standin.h ), the timer adds
+one wakeup per measurement.
+SIGINT / SIGTERM stop the daemon, which then reports wakeups, samples,
+I2C ioctls and the CPU time used to stderr.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <sys/resource.h>
+
+#include "__joystick_driver.c"
+#include "joystick_standin.h"
+#include "joystick_shm.h"
+
+#define REREAD_MAX      4
+
+static uint8_t standIn;
+static int intFd;
+static int clockFd;
+
+/* Stand-in measurement clock, a falling INT edge is an eventfd write */
+static void standInClock( void )
+{
+    uint64_t expirations;
+    uint64_t one;
+    uint8_t before;
+
+    if ( read( clockFd, &expirations, sizeof( expirations ) ) != (ssize_t)sizeof( expirations ) )
+        return;
+
+    one = 1;
+
+    while ( expirations-- )
+    {
+        before = joystick_standInIntGet();
+        joystick_standInMeasure();
+
+        if ( before && !joystick_standInIntGet() && write( intFd, &one, sizeof( one ) ) < 0 )
+            perror( "eventfd" );
+    }
+}
+
+static void intAck( void )
+{
+    uint64_t count;
+
+    if ( standIn )
+    {
+        if ( read( intFd, &count, sizeof( count ) ) < 0 )
+            return;
+    }
+    else
+    {
+        hal_linuxIntAck( intFd );
+    }
+}
+
+/* Load and apply the calibration blob of path, returns 0 on success */
+static int loadCalibration( const char *path )
+{
+    uint8_t blob[ _JOYSTICK_CALIBRATION_SIZE ];
+    FILE *file;
+    size_t n;
+
+    file = fopen( path, "rb" );
+
+    if ( !file )
+        return 1;
+
+    n = fread( blob, 1, sizeof( blob ), file );
+    fclose( file );
+
+    if ( n != sizeof( blob ) || !joystick_setCalibration( blob ) )
+        return 1;
+
+    joystick_setCalibrationMode( _JOYSTICK_CALIBRATION_APPLY );
+
+    return 0;
+}
+
+static int epollAdd( int epfd, int fd )
+{
+    struct epoll_event ev;
+
+    memset( &ev, 0, sizeof( ev ) );
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+
+    return epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &ev );
+}
+
+int main( int argc, char **argv )
+{
+    T_hal_linuxBus bus;
+    T_hal_gpioObj gpio;
+    T_joystick_sample sample;
+    T_joystick_shmState *shm;
+    const char *calibration;
+    struct epoll_event events[ 4 ];
+    struct itimerspec period;
+    struct rusage usage;
+    sigset_t stop;
+    uint64_t start;
+    uint64_t wakeups;
+    uint64_t edges;
+    uint64_t published;
+    uint64_t limit;
+    uint32_t ioctls;
+    uint8_t address;
+    uint8_t position;
+    uint8_t reread;
+    long periodMs;
+    long buttonLine;
+    int running;
+    int epfd;
+    int sigFd;
+    int n;
+    int i;
+    int opt;
+    int8_t ox;
+    int8_t oy;
+
+    shm = 0;
+    calibration = 0;
+    buttonLine = -1;
+
+    while ( ( opt = getopt( argc, argv, "p:c:b:" ) ) != -1 )
+    {
+        if ( opt == 'p' )
+        {
+            shm = joystick_shmCreate( optarg );
+
+            if ( !shm )
+            {
+                perror( optarg );
+                return 1;
+            }
+        }
+        else if ( opt == 'c' )
+        {
+            calibration = optarg;
+        }
+        else if ( opt == 'b' )
+        {
+            buttonLine = atol( optarg );
+        }
+        else
+        {
+            argc = 0;
+            break;
+        }
+    }
+
+    // positional arguments follow the program name as without options
+    argv[ optind - 1 ] = argv[ 0 ];
+    argv += optind - 1;
+    argc -= optind - 1;
+
+    if ( argc < 2 || ( strcmp( argv[ 1 ], "-" ) && argc < 4 ) || ( buttonLine >= 0 && !strcmp( argv[ 1 ], "-" ) ) )
+    {
+        fprintf( stderr, "usage : %s [-p /name] [-c file] [-b line] /dev/i2c-N /dev/gpiochipN line [address] | [-p /name] [-c file] - [periodMs] [samples]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    standIn = !strcmp( argv[ 1 ], "-" );
+    address = _JOYSTICK_I2C_ADDRESS_0;
+    periodMs = 10;
+    limit = 0;
+    clockFd = -1;
+
+    if ( standIn )
+    {
+        periodMs = argc > 2 ? atol( argv[ 2 ] ) : 10;
+        limit = argc > 3 ? strtoull( argv[ 3 ], 0, 10 ) : 0;
+
+        joystick_standInInit( 1 );
+        hal_linuxBusOpen( &bus, 0, joystick_standInIoctl );
+        hal_linuxGpioObj( &gpio );
+        gpio.gpioGet[ __INT_PIN_INPUT__ ] = joystick_standInIntGet;
+
+        intFd = eventfd( 0, EFD_NONBLOCK );
+        clockFd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK );
+
+        if ( intFd < 0 || clockFd < 0 || periodMs < 1 )
+        {
+            perror( "stand-in" );
+            return 1;
+        }
+    }
+    else
+    {
+        if ( argc > 4 )
+            address = (uint8_t)strtol( argv[ 4 ], 0, 0 );
+
+        if ( hal_linuxBusOpen( &bus, argv[ 1 ], 0 ) )
+        {
+            perror( argv[ 1 ] );
+            return 1;
+        }
+
+        intFd = hal_linuxIntOpen( argv[ 2 ], (uint32_t)atol( argv[ 3 ] ) );
+
+        if ( intFd < 0 || ( buttonLine >= 0 && hal_linuxButtonOpen( argv[ 2 ], (uint32_t)buttonLine ) < 0 ) )
+        {
+            perror( argv[ 2 ] );
+            return 1;
+        }
+
+        hal_linuxGpioObj( &gpio );
+    }
+
+    joystick_i2cDriverInit( (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, address );
+
+    if ( !joystick_checkIdCode() )
+        fprintf( stderr, "no AS5013 ID code at 0x%02X\n", address );
+
+    joystick_setDefaultConfiguration();
+    joystick_setDeadzone( _JOYSTICK_DEFAULT_LOW_THRESHOLD, _JOYSTICK_DEFAULT_HYSTERESIS );
+
+    if ( calibration && loadCalibration( calibration ) )
+    {
+        fprintf( stderr, "%s : not a calibration blob\n", calibration );
+        return 1;
+    }
+    joystick_startEventMode();
+
+    // signals arrive as fd events, no handler races with the loop
+    sigemptyset( &stop );
+    sigaddset( &stop, SIGINT );
+    sigaddset( &stop, SIGTERM );
+    sigprocmask( SIG_BLOCK, &stop, 0 );
+    sigFd = signalfd( -1, &stop, SFD_NONBLOCK );
+
+    epfd = epoll_create1( 0 );
+
+    if ( epfd < 0 || sigFd < 0 || epollAdd( epfd, intFd ) || epollAdd( epfd, sigFd ) ||
+         ( standIn && epollAdd( epfd, clockFd ) ) )
+    {
+        perror( "epoll" );
+        return 1;
+    }
+
+    if ( standIn )
+    {
+        period.it_interval.tv_sec = periodMs / 1000;
+        period.it_interval.tv_nsec = ( periodMs % 1000 ) * 1000000L;
+        period.it_value = period.it_interval;
+        timerfd_settime( clockFd, 0, &period, 0 );
+    }
+
+    // a measurement pending from before the edge detection started
+    if ( !joystick_getInterrupt() )
+        joystick_isrHandler();
+
+    wakeups = 0;
+    edges = 0;
+    published = 0;
+    position = _JOYSTICK_POSITION_START;
+    ioctls = bus.ioctls;
+    start = hal_linuxTimeUs();
+    running = 1;
+
+    while ( running )
+    {
+        n = epoll_wait( epfd, events, 4, -1 );
+
+        if ( n < 0 )
+            continue;
+
+        wakeups++;
+
+        for ( i = 0; i < n; i++ )
+        {
+            if ( events[ i ].data.fd == sigFd )
+                running = 0;
+            else if ( events[ i ].data.fd == clockFd )
+                standInClock();
+            else if ( events[ i ].data.fd == intFd )
+            {
+                intAck();
+                edges++;
+
+                reread = 0;
+
+                do
+                    joystick_isrHandler();
+                while ( !joystick_getInterrupt() && ++reread < REREAD_MAX );
+            }
+        }
+
+        while ( joystick_popSample( &sample ) )
+        {
+            ox = sample.x;
+            oy = sample.y;
+            joystick_process( &ox, &oy );
+            joystick_updatePosition( ox, oy, &position );
+
+            if ( shm )
+                joystick_shmPublish( shm, hal_linuxTimeUs(), ox, oy, sample.button, position );
+            else if ( buttonLine >= 0 )
+                printf( "%llu %d %d %u %u\n", (unsigned long long)( hal_linuxTimeUs() - start ),
+                        ox, oy, sample.button, position );
+            else
+                printf( "%llu %d %d %u\n", (unsigned long long)( hal_linuxTimeUs() - start ),
+                        ox, oy, position );
+            published++;
+        }
+
+        fflush( stdout );
+
+        if ( limit && published >= limit )
+            running = 0;
+    }
+
+    getrusage( RUSAGE_SELF, &usage );
+
+    fprintf( stderr, "%llu wakeups, %llu INT edges, %llu samples, %u dropped, %lu I2C ioctls, %.3f s wall, %.3f s CPU\n",
+             (unsigned long long)wakeups, (unsigned long long)edges, (unsigned long long)published,
+             joystick_getDroppedSamples(), (unsigned long)( bus.ioctls - ioctls ),
+             ( hal_linuxTimeUs() - start ) * 1e-6,
+             usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) * 1e-6 );
+
+    if ( !standIn )
+    {
+        hal_linuxIntClose();
+        hal_linuxButtonClose();
+    }
+
+    hal_linuxBusClose( &bus );
+
+    return 0;
+}
@@ -0,0 +1,355 @@
+/*
+Joystick Click multi-bus polling engine
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX threads )
+    Compiler         : gcc / clang ( C99 )
+    Build ( sim )    : cc -std=c99 -O2 -pthread -D__HAL_HOST_SIM__ -D__HAL_THREADS__ -I../library -I../library/HAL joystick_engine.c -o joystick_engine
+    Build ( Linux )  : cc -std=c99 -O2 -pthread -D__HAL_LINUX__ -D__HAL_THREADS__ -I../library -I../library/HAL joystick_engine.c -o joystick_engine_i2c
+
+---
+
+Description :
+
+Runs the engine of joystick_engine.h, one worker thread per bus, and
+consumes every device queue from the main thread, checking that no
+sample is lost or reordered.
+
+- joystick_engine [-t seconds] [-p periodUs] [-d devices] [buses]      - simulated 400 kHz buses ( default 4 buses, 2 devices )
+- joystick_engine_i2c [-t seconds] [-p periodUs] /dev/i2c-1 /dev/i2c-2 ...  - one bus per adapter, devices at 0x40 and 0x41
+
+-t sets the run time ( default 1 s ), -p the read period of every bus
+( default 0, back to back ). An AS5013 answers at 0x40 or 0x41, so a bus
+carries at most two clicks; the simulated buses follow that limit, and
+-d 1 leaves one device per bus.
+
+Reported per bus : devices answering the ID code, polling cycles,
+samples consumed, samples dropped on full queues, reads failed on the
+bus and cycles late for the period. The simulated build also reports the rate each bus sustains on
+its virtual bus clock, every worker keeping its own clock, which adds up
+with the number of buses however many CPUs run the workers.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "__joystick_driver.c"
+#include "joystick_engine.h"
+
+#define BUSES_MAX       32
+#define DEVICES_MAX     2
+
+static T_joystick_engineBus buses[ BUSES_MAX ];
+static T_joystick_engineDevice devices[ BUSES_MAX ][ DEVICES_MAX ];
+static T_hal_gpioObj gpios[ BUSES_MAX ][ DEVICES_MAX ];
+
+#ifdef __HAL_HOST_SIM__
+
+/* Full circle in 800 ms followed by a button press */
+static const T_hal_simPoint circlePath[] =
+{
+    {      0,    0,    0, 0 },
+    { 100000,  100,    0, 0 },
+    { 200000,  100,  100, 0 },
+    { 300000,    0,  100, 0 },
+    { 400000, -100,  100, 0 },
+    { 500000, -100,    0, 0 },
+    { 600000, -100, -100, 0 },
+    { 700000,    0, -100, 0 },
+    { 800000,  100, -100, 0 },
+    { 900000,    0,    0, 1 },
+    { 950000,    0,    0, 0 }
+};
+
+/* Slow drift around the center */
+static const T_hal_simPoint driftPath[] =
+{
+    {      0,   0,   0, 0 },
+    { 400000,  25,  -5, 0 },
+    { 800000, -25,   5, 0 }
+};
+
+static T_hal_simBus simBuses[ BUSES_MAX ];
+static T_hal_simDevice simDevices[ BUSES_MAX ][ DEVICES_MAX ];
+
+/* Virtual clock of the calling worker */
+static uint64_t simClock()
+{
+    return hal_simTimeUs;
+}
+
+/* Pin slots are per thread, bind them in the worker */
+static void simSetup( T_joystick_engineBus *bus, T_joystick_engineDevice *dev )
+{
+    uint32_t b;
+    uint32_t d;
+
+    b = (uint32_t)( bus - buses );
+    d = (uint32_t)( dev - devices[ b ] );
+
+    hal_simGpioObj( &gpios[ b ][ d ], (uint8_t)d, &simDevices[ b ][ d ] );
+}
+
+#else
+
+static T_hal_linuxBus linuxBuses[ BUSES_MAX ];
+
+static void linuxSetup( T_joystick_engineBus *bus, T_joystick_engineDevice *dev )
+{
+    uint32_t b;
+
+    b = (uint32_t)( bus - buses );
+
+    hal_linuxGpioObj( &gpios[ b ][ dev - devices[ b ] ] );
+}
+
+#endif
+
+static void usage( const char *name )
+{
+#ifdef __HAL_HOST_SIM__
+    fprintf( stderr, "usage : %s [-t seconds] [-p periodUs] [-d devices] [buses]\n", name );
+#else
+    fprintf( stderr, "usage : %s [-t seconds] [-p periodUs] /dev/i2c-N ...\n", name );
+#endif
+}
+
+int main( int argc, char **argv )
+{
+    T_joystick_engineSample sample;
+    T_joystick_engineDevice *dev;
+    struct timespec idle;
+    uint64_t busSamples[ BUSES_MAX ];
+    uint64_t firstUs[ BUSES_MAX ][ DEVICES_MAX ];
+    uint64_t lastUs[ BUSES_MAX ][ DEVICES_MAX ];
+    uint64_t total;
+    uint64_t disorder;
+    uint64_t start;
+    uint64_t stop;
+    uint32_t expected[ BUSES_MAX ][ DEVICES_MAX ];
+    uint32_t firstSeq[ BUSES_MAX ][ DEVICES_MAX ];
+    uint32_t nBuses;
+    uint32_t started;
+    uint32_t periodUs;
+    uint32_t nDev;
+    uint32_t present;
+    uint32_t dropped;
+    uint32_t errors;
+    uint32_t b;
+    uint32_t d;
+    double seconds;
+    double busRate;
+    double busTotal;
+    uint8_t popped;
+    uint8_t failed;
+    int opt;
+
+    seconds = 1.0;
+    periodUs = 0;
+    nDev = DEVICES_MAX;
+
+    while ( ( opt = getopt( argc, argv, "t:p:d:" ) ) != -1 )
+    {
+        if ( opt == 't' )
+            seconds = atof( optarg );
+        else if ( opt == 'p' )
+            periodUs = (uint32_t)atol( optarg );
+        else if ( opt == 'd' )
+            nDev = (uint32_t)atol( optarg );
+        else
+        {
+            usage( argv[ 0 ] );
+            return 1;
+        }
+    }
+
+    if ( nDev < 1 || nDev > DEVICES_MAX || seconds <= 0 )
+    {
+        usage( argv[ 0 ] );
+        return 1;
+    }
+
+#ifdef __HAL_HOST_SIM__
+    nBuses = optind < argc ? (uint32_t)atol( argv[ optind ] ) : 4;
+
+    if ( nBuses < 1 || nBuses > BUSES_MAX )
+    {
+        usage( argv[ 0 ] );
+        return 1;
+    }
+
+    for ( b = 0; b < nBuses; b++ )
+    {
+        hal_simBusInit( &simBuses[ b ], 400000 );
+        joystick_engineBusInit( &buses[ b ], (T_JOYSTICK_P)&simBuses[ b ], periodUs, simClock, simSetup, 0 );
+
+        for ( d = 0; d < nDev; d++ )
+        {
+            if ( d & 1 )
+                hal_simDeviceInit( &simDevices[ b ][ d ], _JOYSTICK_I2C_ADDRESS_1, driftPath, 3, 1 );
+            else
+                hal_simDeviceInit( &simDevices[ b ][ d ], _JOYSTICK_I2C_ADDRESS_0, circlePath, 11, 1 );
+
+            hal_simBusAttach( &simBuses[ b ], &simDevices[ b ][ d ] );
+            joystick_engineDeviceInit( &devices[ b ][ d ], (T_JOYSTICK_P)&gpios[ b ][ d ], simDevices[ b ][ d ].address );
+            joystick_engineAttach( &buses[ b ], &devices[ b ][ d ] );
+        }
+    }
+#else
+    nBuses = (uint32_t)( argc - optind );
+
+    if ( nBuses < 1 || nBuses > BUSES_MAX )
+    {
+        usage( argv[ 0 ] );
+        return 1;
+    }
+
+    for ( b = 0; b < nBuses; b++ )
+    {
+        if ( hal_linuxBusOpen( &linuxBuses[ b ], argv[ optind + b ], 0 ) )
+        {
+            perror( argv[ optind + b ] );
+            return 1;
+        }
+
+        joystick_engineBusInit( &buses[ b ], (T_JOYSTICK_P)&linuxBuses[ b ], periodUs, hal_linuxTimeUs, linuxSetup, 0 );
+
+        for ( d = 0; d < nDev; d++ )
+        {
+            joystick_engineDeviceInit( &devices[ b ][ d ], (T_JOYSTICK_P)&gpios[ b ][ d ],
+                                       d ? _JOYSTICK_I2C_ADDRESS_1 : _JOYSTICK_I2C_ADDRESS_0 );
+            joystick_engineAttach( &buses[ b ], &devices[ b ][ d ] );
+        }
+    }
+#endif
+
+    memset( expected, 0, sizeof( expected ) );
+    memset( busSamples, 0, sizeof( busSamples ) );
+    memset( firstUs, 0, sizeof( firstUs ) );
+    memset( lastUs, 0, sizeof( lastUs ) );
+    memset( firstSeq, 0, sizeof( firstSeq ) );
+    total = 0;
+    disorder = 0;
+
+    idle.tv_sec = 0;
+    idle.tv_nsec = 200000;
+
+    start = _joystick_engineMonotonicUs();
+    stop = start + (uint64_t)( seconds * 1e6 );
+    started = joystick_engineStart( buses, nBuses );
+
+    if ( started < nBuses )
+    {
+        perror( "pthread_create" );
+        joystick_engineStop( buses, started );
+        return 1;
+    }
+
+    while ( _joystick_engineMonotonicUs() < stop )
+    {
+        popped = 0;
+
+        for ( b = 0; b < nBuses; b++ )
+        {
+            for ( d = 0; d < nDev; d++ )
+            {
+                while ( joystick_enginePop( &devices[ b ][ d ], &sample ) )
+                {
+                    // a full queue or a failed read drops samples, the sequence then jumps
+                    if ( sample.sequence < expected[ b ][ d ] )
+                        disorder++;
+
+                    if ( !expected[ b ][ d ] )
+                    {
+                        firstUs[ b ][ d ] = sample.timestampUs;
+                        firstSeq[ b ][ d ] = sample.sequence;
+                    }
+
+                    expected[ b ][ d ] = sample.sequence + 1;
+                    lastUs[ b ][ d ] = sample.timestampUs;
+                    busSamples[ b ]++;
+                    total++;
+                    popped = 1;
+                }
+            }
+        }
+
+        if ( !popped )
+            nanosleep( &idle, 0 );
+    }
+
+    joystick_engineStop( buses, nBuses );
+    stop = _joystick_engineMonotonicUs();
+
+    failed = 0;
+
+    for ( b = 0; b < nBuses; b++ )
+    {
+        if ( buses[ b ].error )
+        {
+            fprintf( stderr, "bus %u stopped : %s\n", b, strerror( buses[ b ].error ) );
+            failed = 1;
+        }
+    }
+
+    printf( "%-4s %8s %10s %10s %8s %8s %8s", "bus", "devices", "cycles", "samples", "dropped", "errors", "late" );
+#ifdef __HAL_HOST_SIM__
+    printf( " %14s", "bus samples/s" );
+#endif
+    printf( "\n" );
+
+    busTotal = 0;
+
+    for ( b = 0; b < nBuses; b++ )
+    {
+        present = 0;
+        dropped = 0;
+        errors = 0;
+        busRate = 0.0;
+
+        for ( d = 0; d < nDev; d++ )
+        {
+            dev = &devices[ b ][ d ];
+            present += dev->present;
+            dropped += dev->dropped;
+            errors += dev->errors;
+
+            // reads per virtual second, from the sequence so dropped samples count as read
+            if ( lastUs[ b ][ d ] > firstUs[ b ][ d ] )
+                busRate += ( expected[ b ][ d ] - 1 - firstSeq[ b ][ d ] ) * 1e6 / ( lastUs[ b ][ d ] - firstUs[ b ][ d ] );
+        }
+
+        printf( "%-4u %8u %10llu %10llu %8u %8u %8llu", b, present, (unsigned long long)buses[ b ].cycles,
+                (unsigned long long)busSamples[ b ], dropped, errors, (unsigned long long)buses[ b ].lateCycles );
+#ifdef __HAL_HOST_SIM__
+        busTotal += busRate;
+        printf( " %14.0f", busRate );
+#else
+        (void)busRate;
+        hal_linuxBusClose( &linuxBuses[ b ] );
+#endif
+        printf( "\n" );
+    }
+
+    printf( "\n%llu samples in %.3f s, %.0f samples/s consumed, %llu out of order\n",
+            (unsigned long long)total, ( stop - start ) * 1e-6, total * 1e6 / ( stop - start ),
+            (unsigned long long)disorder );
+#ifdef __HAL_HOST_SIM__
+    printf( "%.0f samples/s on %u virtual 400 kHz buses\n", busTotal, nBuses );
+#else
+    (void)busTotal;
+#endif
+
+    if ( failed )
+        return 1;
+
+    return disorder ? 2 : 0;
+}
@@ -0,0 +1,338 @@
+/*
+Joystick Click multi-bus polling engine
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX threads )
+    Compiler         : gcc / clang ( C99 )
+
+---
+
+Description :
+
+Polls many Joystick clicks spread over several I2C buses. Every bus is
+owned by one worker thread which reads its devices back to back, each
+with one burst read of X and Y ( joystick_ctxReadXY() ) and the button
+level, and pushes the sample into the device's queue. Consumers pop
+samples per device from any thread. A read failing on the bus
+( joystick_ctxGetI2cError() ) is counted in the device's errors and its
+sample is not queued, the sequence still counts it.
+
+- joystick_engineBusInit() / joystick_engineDeviceInit() / joystick_engineAttach()
+  describe the buses and devices,
+- joystick_engineStart() starts one worker per bus, joystick_engineStop()
+  stops and joins them. A worker which cannot sleep until its next cycle
+  stops by itself and leaves the error number in its bus' error,
+- joystick_enginePop() takes the oldest sample of a device.
+
+Register access goes through the driver contexts, so the driver must be
+built with __HAL_THREADS__ : the HAL mapping and the active context are
+then thread local and workers of different buses do not remap each other.
+A context is only used by the worker of its bus. Pins of the platform HAL
+may have per thread state as well ( hal_simGpioObj(), hal_linuxIntOpen() ),
+the setup callback of the bus binds them in the worker, before the
+devices are initialized.
+
+Each device queue is a single producer ( bus worker ) / single consumer
+ring without locks : the worker only writes head, the consumer only
+writes tail, and a full queue counts the sample as dropped instead of
+blocking the bus. Buses share nothing, so with one adapter per bus the
+workers overlap their transfers and throughput grows with the number of
+buses.
+
+The header is shared by the host tools, which define _POSIX_C_SOURCE
+200809L before including any system header. Include after
+__joystick_driver.c and link with -pthread.
+
+*/
+
+#ifndef _JOYSTICK_ENGINE_H_
+#define _JOYSTICK_ENGINE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#define _JOYSTICK_ENGINE_QUEUE_SIZE     1024
+#define _JOYSTICK_ENGINE_QUEUE_MASK     ( _JOYSTICK_ENGINE_QUEUE_SIZE - 1 )
+#define _JOYSTICK_ENGINE_MAX_DEVICES    8
+
+/** Monotonic time in microseconds of the bus' worker */
+typedef uint64_t (*T_joystick_engineClockFp)();
+
+/** Timestamped sample, sequence counts the reads of the device from 0 */
+typedef struct
+{
+    uint64_t            timestampUs;
+    uint32_t            sequence;
+    int8_t              x;
+    int8_t              y;
+    uint8_t             button;
+
+}T_joystick_engineSample;
+
+/** Device on a bus with its driver context and sample queue */
+typedef struct
+{
+    T_joystick_ctx              ctx;
+    T_JOYSTICK_P                gpioObj;
+    uint8_t                     address;
+    uint8_t                     present;
+
+    T_joystick_engineSample     queue[ _JOYSTICK_ENGINE_QUEUE_SIZE ];
+    volatile uint32_t           head;
+    volatile uint32_t           tail;
+    volatile uint32_t           dropped;
+    volatile uint32_t           errors;
+    uint32_t                    sequence;
+
+}T_joystick_engineDevice;
+
+struct T_joystick_engineBus;
+
+/** Called in the worker for each device before its context is initialized */
+typedef void (*T_joystick_engineSetupFp)( struct T_joystick_engineBus*, T_joystick_engineDevice* );
+
+/** Bus, its devices and the worker polling them */
+typedef struct T_joystick_engineBus
+{
+    T_JOYSTICK_P                i2cObj;
+    T_joystick_engineDevice    *dev[ _JOYSTICK_ENGINE_MAX_DEVICES ];
+    uint8_t                     nDev;
+    uint32_t                    periodUs;
+    T_joystick_engineClockFp    clock;
+    T_joystick_engineSetupFp    setup;
+    void                       *arg;
+
+    pthread_t                   thread;
+    volatile uint8_t            running;
+    volatile int                error;
+    volatile uint64_t           cycles;
+    volatile uint64_t           lateCycles;
+
+}T_joystick_engineBus;
+
+/* ------------------------------------------------------------------- QUEUE */
+
+/** Producer side, called by the bus worker only */
+static void _joystick_enginePush( T_joystick_engineDevice *dev, const T_joystick_engineSample *sample )
+{
+    uint32_t head;
+
+    head = dev->head;
+
+    if ( head - dev->tail >= _JOYSTICK_ENGINE_QUEUE_SIZE )
+    {
+        dev->dropped++;
+        return;
+    }
+
+    dev->queue[ head & _JOYSTICK_ENGINE_QUEUE_MASK ] = *sample;
+
+    // the sample is visible before the new head
+    _JOYSTICK_BARRIER();
+    dev->head = head + 1;
+}
+
+/** Take the oldest sample of dev, returns 0 when the queue is empty. One consumer per device. */
+static uint8_t joystick_enginePop( T_joystick_engineDevice *dev, T_joystick_engineSample *sample )
+{
+    uint32_t tail;
+
+    tail = dev->tail;
+
+    if ( tail == dev->head )
+        return 0;
+
+    _JOYSTICK_BARRIER();
+    *sample = dev->queue[ tail & _JOYSTICK_ENGINE_QUEUE_MASK ];
+
+    // the slot is read before the worker may reuse it
+    _JOYSTICK_BARRIER();
+    dev->tail = tail + 1;
+
+    return 1;
+}
+
+/* ------------------------------------------------------------------ WORKER */
+
+/** Returns 0 or the error number of clock_nanosleep(), signals only restart the sleep */
+static int _joystick_engineSleepUntil( uint64_t deadlineUs )
+{
+    struct timespec ts;
+    int ret;
+
+    ts.tv_sec = (time_t)( deadlineUs / 1000000u );
+    ts.tv_nsec = (long)( deadlineUs % 1000000u ) * 1000L;
+
+    do
+        ret = clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0 );
+    while ( ret == EINTR );
+
+    return ret;
+}
+
+static uint64_t _joystick_engineMonotonicUs()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void *_joystick_engineWorker( void *arg )
+{
+    T_joystick_engineBus *bus;
+    T_joystick_engineDevice *dev;
+    T_joystick_engineSample sample;
+    uint64_t next;
+    uint64_t now;
+    uint8_t i;
+
+    bus = (T_joystick_engineBus*)arg;
+
+    for ( i = 0; i < bus->nDev; i++ )
+    {
+        dev = bus->dev[ i ];
+
+        if ( bus->setup )
+            bus->setup( bus, dev );
+
+        joystick_ctxI2cDriverInit( &dev->ctx, dev->gpioObj, bus->i2cObj, dev->address );
+        dev->present = joystick_ctxCheckIdCode( &dev->ctx );
+
+        if ( dev->present )
+            joystick_ctxSetDefaultConfiguration( &dev->ctx );
+    }
+
+    next = _joystick_engineMonotonicUs();
+
+    while ( bus->running )
+    {
+        for ( i = 0; i < bus->nDev; i++ )
+        {
+            dev = bus->dev[ i ];
+
+            if ( !dev->present )
+                continue;
+
+            joystick_ctxGetI2cError( &dev->ctx );
+            joystick_ctxReadXY( &dev->ctx, &sample.x, &sample.y );
+            sample.sequence = dev->sequence++;
+
+            // X and Y of a failed transfer are not a position
+            if ( joystick_ctxGetI2cError( &dev->ctx ) )
+            {
+                dev->errors++;
+                continue;
+            }
+
+            sample.button = joystick_ctxPressButton( &dev->ctx );
+            sample.timestampUs = bus->clock();
+
+            _joystick_enginePush( dev, &sample );
+        }
+
+        bus->cycles++;
+
+        if ( !bus->periodUs )
+            continue;
+
+        // fixed rate, a late cycle restarts the schedule instead of bursting to catch up
+        next += bus->periodUs;
+        now = _joystick_engineMonotonicUs();
+
+        if ( now >= next )
+        {
+            bus->lateCycles++;
+            next = now;
+        }
+        else
+        {
+            bus->error = _joystick_engineSleepUntil( next );
+
+            // retrying would spin on the same error
+            if ( bus->error )
+                bus->running = 0;
+        }
+    }
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------- API */
+
+/** Bus on i2cObj read every periodUs ( 0 : back to back ), samples stamped by clock */
+static void joystick_engineBusInit( T_joystick_engineBus *bus, T_JOYSTICK_P i2cObj, uint32_t periodUs,
+                                    T_joystick_engineClockFp clock, T_joystick_engineSetupFp setup, void *arg )
+{
+    memset( bus, 0, sizeof( T_joystick_engineBus ) );
+
+    bus->i2cObj = i2cObj;
+    bus->periodUs = periodUs;
+    bus->clock = clock ? clock : _joystick_engineMonotonicUs;
+    bus->setup = setup;
+    bus->arg = arg;
+}
+
+/** Device at 7-bit address with GPIO object gpioObj */
+static void joystick_engineDeviceInit( T_joystick_engineDevice *dev, T_JOYSTICK_P gpioObj, uint8_t address )
+{
+    dev->gpioObj = gpioObj;
+    dev->address = address;
+    dev->present = 0;
+    dev->head = 0;
+    dev->tail = 0;
+    dev->dropped = 0;
+    dev->errors = 0;
+    dev->sequence = 0;
+}
+
+/** Add dev to bus, returns 1 when the bus is full */
+static uint8_t joystick_engineAttach( T_joystick_engineBus *bus, T_joystick_engineDevice *dev )
+{
+    if ( bus->nDev >= _JOYSTICK_ENGINE_MAX_DEVICES )
+        return 1;
+
+    bus->dev[ bus->nDev++ ] = dev;
+
+    return 0;
+}
+
+/** Start one worker per bus, returns the number of buses started */
+static uint32_t joystick_engineStart( T_joystick_engineBus *buses, uint32_t nBuses )
+{
+    uint32_t i;
+
+    for ( i = 0; i < nBuses; i++ )
+    {
+        buses[ i ].running = 1;
+
+        if ( pthread_create( &buses[ i ].thread, 0, _joystick_engineWorker, &buses[ i ] ) )
+        {
+            buses[ i ].running = 0;
+            break;
+        }
+    }
+
+    return i;
+}
+
+/** Stop and join the workers of the first nBuses buses */
+static void joystick_engineStop( T_joystick_engineBus *buses, uint32_t nBuses )
+{
+    uint32_t i;
+
+    for ( i = 0; i < nBuses; i++ )
+        buses[ i ].running = 0;
+
+    for ( i = 0; i < nBuses; i++ )
+        pthread_join( buses[ i ].thread, 0 );
+}
+
+#endif
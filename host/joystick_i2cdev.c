@@ -0,0 +1,108 @@
+/*
+Joystick Click on Linux i2c-dev
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_LINUX__ -I../library -I../library/HAL joystick_i2cdev.c -o joystick_i2cdev
+
+---
+
+Description :
+
+Polls a Joystick click on an i2c-dev adapter through the Linux HAL and
+prints direction changes, then the number of ioctl calls per sample.
+
+- joystick_i2cdev /dev/i2c-1 [samples] [periodMs] [address]   - click on the adapter ( default 1000 samples, 10 ms, 0x40 )
+- joystick_i2cdev - [samples] [periodMs]                        - built-in stand-in for the adapter, no hardware needed
+
+The stand-in ( joystick_standin.h ) answers I2C_RDWR like an AS5013 at
+0x40, so the HAL and the driver run unchanged.
+Every sample costs one ioctl : joystick_getPositionEvent() reads X and Y
+in one burst, register address write and data read combined.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "__joystick_driver.c"
+#include "joystick_standin.h"
+
+static const char *positionName[ 9 ] =
+{
+    "Start", "Top", "Top-Right", "Right", "Bottom-Right",
+    "Bottom", "Bottom-Left", "Left", "Top-Left"
+};
+
+int main( int argc, char **argv )
+{
+    T_hal_linuxBus bus;
+    T_hal_gpioObj gpio;
+    uint64_t start;
+    uint32_t ioctls;
+    uint8_t standIn;
+    uint8_t address;
+    uint8_t position;
+    long samples;
+    long periodMs;
+    long i;
+    long t;
+
+    if ( argc < 2 )
+    {
+        fprintf( stderr, "usage : %s /dev/i2c-N | - [samples] [periodMs] [address]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    standIn = !strcmp( argv[ 1 ], "-" );
+    samples = argc > 2 ? atol( argv[ 2 ] ) : 1000;
+    periodMs = argc > 3 ? atol( argv[ 3 ] ) : 10;
+    address = argc > 4 ? (uint8_t)strtol( argv[ 4 ], 0, 0 ) : _JOYSTICK_I2C_ADDRESS_0;
+
+    if ( standIn )
+        joystick_standInInit( 0 );
+
+    if ( hal_linuxBusOpen( &bus, standIn ? 0 : argv[ 1 ], standIn ? joystick_standInIoctl : 0 ) )
+    {
+        perror( argv[ 1 ] );
+        return 1;
+    }
+
+    hal_linuxGpioObj( &gpio );
+
+    joystick_i2cDriverInit( (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, address );
+
+    if ( !joystick_checkIdCode() )
+        fprintf( stderr, "no AS5013 ID code at 0x%02X\n", address );
+
+    joystick_setDefaultConfiguration();
+    joystick_setDeadzone( _JOYSTICK_DEFAULT_LOW_THRESHOLD, _JOYSTICK_DEFAULT_HYSTERESIS );
+
+    ioctls = bus.ioctls;
+    start = hal_linuxTimeUs();
+
+    for ( i = 0; i < samples; i++ )
+    {
+        if ( joystick_getPositionEvent( &position ) )
+            printf( "%8.3f s  %s\n", ( hal_linuxTimeUs() - start ) * 1e-6, positionName[ position ] );
+
+        for ( t = 0; t < periodMs; t++ )
+            Delay_1ms();
+    }
+
+    ioctls = bus.ioctls - ioctls;
+
+    printf( "\n%ld samples, %lu ioctl calls, %.2f per sample, %lu errors\n",
+            samples, (unsigned long)ioctls, samples ? (double)ioctls / samples : 0.0, (unsigned long)bus.errors );
+
+    hal_linuxBusClose( &bus );
+
+    return bus.errors ? 2 : 0;
+}
@@ -0,0 +1,225 @@
+/*
+Joystick Click shared-memory state
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX shared memory )
+    Compiler         : gcc / clang ( C99 )
+
+---
+
+Description :
+
+Latest stick state in a POSIX shared-memory segment, written by one
+publisher ( e.g. joystick_daemon ) and read by any number of processes
+without system calls or locks, so only the publisher touches the bus.
+
+The state is guarded by a seqlock : the publisher makes the sequence odd,
+writes the fields and makes it even again; a reader copies the fields
+between two reads of an even, unchanged sequence and retries otherwise.
+Readers never block the publisher, a reader racing a write retries once.
+
+| Offset | Field                                                           |
+|:------:|:----------------------------------------------------------------|
+| 0      | "JSHM"                                                          |
+| 4      | version                                                         |
+| 8      | sequence, even when stable, + 2 per update                      |
+| 16     | timestamp in microseconds ( publisher's monotonic clock )       |
+| 24     | X, Y, button, position ( _JOYSTICK_POSITION_* )                 |
+| 28     | samples published                                               |
+
+X and Y are published after joystick_process(), calibrated only when the
+publisher applies a calibration ( joystick_daemon -c ). The button reads
+0 when the publisher has no button line ( joystick_daemon without -b ).
+
+The header is shared by the host tools, which define _POSIX_C_SOURCE
+200809L before including any system header. Include after
+__joystick_driver.c ( _JOYSTICK_BARRIER() ).
+
+*/
+
+#ifndef _JOYSTICK_SHM_H_
+#define _JOYSTICK_SHM_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define _JOYSTICK_SHM_VERSION       1
+#define _JOYSTICK_SHM_RETRY_MAX     1000
+
+/** Shared segment */
+typedef struct
+{
+    char                magic[ 4 ];
+    uint32_t            version;
+    volatile uint32_t   sequence;
+    uint32_t            reserved;
+    volatile uint64_t   timestampUs;
+    volatile int8_t     x;
+    volatile int8_t     y;
+    volatile uint8_t    button;
+    volatile uint8_t    position;
+    volatile uint32_t   samples;
+
+}T_joystick_shmState;
+
+/** Consistent copy of the state */
+typedef struct
+{
+    uint32_t            sequence;
+    uint64_t            timestampUs;
+    int8_t              x;
+    int8_t              y;
+    uint8_t             button;
+    uint8_t             position;
+    uint32_t            samples;
+
+}T_joystick_shmSnapshot;
+
+/* ---------------------------------------------------------------- PUBLISHER */
+
+/** Create or reset the segment name ( e.g. "/joystick" ), returns the mapping or 0 */
+static inline T_joystick_shmState *joystick_shmCreate( const char *name )
+{
+    T_joystick_shmState *state;
+    int fd;
+
+    fd = shm_open( name, O_RDWR | O_CREAT, 0644 );
+
+    if ( fd < 0 )
+        return 0;
+
+    if ( ftruncate( fd, sizeof( T_joystick_shmState ) ) )
+    {
+        close( fd );
+        return 0;
+    }
+
+    state = (T_joystick_shmState*)mmap( 0, sizeof( T_joystick_shmState ), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+
+    if ( state == (T_joystick_shmState*)MAP_FAILED )
+        return 0;
+
+    // a reader of an older segment sees an odd sequence until the reset is done
+    state->sequence |= 1;
+    _JOYSTICK_BARRIER();
+
+    state->version = _JOYSTICK_SHM_VERSION;
+    state->timestampUs = 0;
+    state->x = 0;
+    state->y = 0;
+    state->button = 0;
+    state->position = 0;
+    state->samples = 0;
+    memcpy( state->magic, "JSHM", 4 );
+
+    _JOYSTICK_BARRIER();
+    state->sequence++;
+
+    return state;
+}
+
+/** Publish one sample, single writer */
+static inline void joystick_shmPublish( T_joystick_shmState *state, uint64_t timestampUs, int8_t x, int8_t y,
+                                 uint8_t button, uint8_t position )
+{
+    state->sequence++;
+    _JOYSTICK_BARRIER();
+
+    state->timestampUs = timestampUs;
+    state->x = x;
+    state->y = y;
+    state->button = button;
+    state->position = position;
+    state->samples++;
+
+    _JOYSTICK_BARRIER();
+    state->sequence++;
+}
+
+/* ------------------------------------------------------------------- READER */
+
+/** Map segment name read only, returns the mapping or 0 */
+static inline const T_joystick_shmState *joystick_shmOpen( const char *name )
+{
+    const T_joystick_shmState *state;
+    struct stat st;
+    int fd;
+
+    fd = shm_open( name, O_RDONLY, 0 );
+
+    if ( fd < 0 )
+        return 0;
+
+    if ( fstat( fd, &st ) || st.st_size < (off_t)sizeof( T_joystick_shmState ) )
+    {
+        close( fd );
+        return 0;
+    }
+
+    state = (const T_joystick_shmState*)mmap( 0, sizeof( T_joystick_shmState ), PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+
+    if ( state == (const T_joystick_shmState*)MAP_FAILED )
+        return 0;
+
+    if ( memcmp( state->magic, "JSHM", 4 ) || state->version != _JOYSTICK_SHM_VERSION )
+    {
+        munmap( (void*)state, sizeof( T_joystick_shmState ) );
+        return 0;
+    }
+
+    return state;
+}
+
+/**
+ * Copy a consistent snapshot. Returns the number of retries + 1, or 0
+ * when no stable copy was taken in _JOYSTICK_SHM_RETRY_MAX attempts
+ * ( publisher stopped in the middle of an update ).
+ */
+static inline uint32_t joystick_shmRead( const T_joystick_shmState *state, T_joystick_shmSnapshot *snap )
+{
+    uint32_t attempt;
+    uint32_t seq;
+
+    for ( attempt = 1; attempt <= _JOYSTICK_SHM_RETRY_MAX; attempt++ )
+    {
+        seq = state->sequence;
+
+        if ( seq & 1 )
+            continue;
+
+        _JOYSTICK_BARRIER();
+
+        snap->timestampUs = state->timestampUs;
+        snap->x = state->x;
+        snap->y = state->y;
+        snap->button = state->button;
+        snap->position = state->position;
+        snap->samples = state->samples;
+
+        _JOYSTICK_BARRIER();
+
+        if ( state->sequence == seq )
+        {
+            snap->sequence = seq;
+            return attempt;
+        }
+    }
+
+    return 0;
+}
+
+static inline void joystick_shmClose( const T_joystick_shmState *state )
+{
+    munmap( (void*)state, sizeof( T_joystick_shmState ) );
+}
+
+#endif
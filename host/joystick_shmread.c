@@ -0,0 +1,133 @@
+/*
+Joystick Click shared-memory reader
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux ( POSIX shared memory )
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_shmread.c -o joystick_shmread -lrt
+
+---
+
+Description :
+
+Reads the stick state published by joystick_daemon -p /name, as UI,
+logger or controller processes would.
+
+- joystick_shmread /name [periodMs]      - print the state when it changed, checked every periodMs ( default 10 )
+- joystick_shmread /name -b [reads]      - time snapshot reads ( default 10,000,000 ) and count retries
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "__joystick_driver.c"
+#include "joystick_shm.h"
+
+static uint64_t nowUs( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int bench( const T_joystick_shmState *state, unsigned long reads )
+{
+    T_joystick_shmSnapshot snap;
+    unsigned long retries;
+    unsigned long failed;
+    unsigned long updates;
+    unsigned long i;
+    uint32_t attempts;
+    uint32_t last;
+    uint64_t t;
+
+    retries = 0;
+    failed = 0;
+    updates = 0;
+    last = 0;
+    t = nowUs();
+
+    for ( i = 0; i < reads; i++ )
+    {
+        attempts = joystick_shmRead( state, &snap );
+
+        if ( !attempts )
+            failed++;
+        else
+            retries += attempts - 1;
+
+        if ( attempts && snap.sequence != last )
+        {
+            last = snap.sequence;
+            updates++;
+        }
+    }
+
+    t = nowUs() - t;
+
+    printf( "%lu reads, %.1f ns per read, %lu retries, %lu failed, %lu updates seen\n",
+            reads, reads ? 1000.0 * t / reads : 0.0, retries, failed, updates );
+
+    return failed ? 2 : 0;
+}
+
+int main( int argc, char **argv )
+{
+    const T_joystick_shmState *state;
+    T_joystick_shmSnapshot snap;
+    struct timespec period;
+    uint32_t last;
+    long periodMs;
+    int ret;
+
+    if ( argc < 2 )
+    {
+        fprintf( stderr, "usage : %s /name [periodMs] | /name -b [reads]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    state = joystick_shmOpen( argv[ 1 ] );
+
+    if ( !state )
+    {
+        fprintf( stderr, "%s : no joystick state segment\n", argv[ 1 ] );
+        return 1;
+    }
+
+    if ( argc > 2 && !strcmp( argv[ 2 ], "-b" ) )
+    {
+        ret = bench( state, argc > 3 ? strtoul( argv[ 3 ], 0, 10 ) : 10000000ul );
+        joystick_shmClose( state );
+        return ret;
+    }
+
+    periodMs = argc > 2 ? atol( argv[ 2 ] ) : 10;
+    period.tv_sec = periodMs / 1000;
+    period.tv_nsec = ( periodMs % 1000 ) * 1000000L;
+    last = 0;
+
+    for ( ;; )
+    {
+        if ( joystick_shmRead( state, &snap ) && snap.sequence != last )
+        {
+            last = snap.sequence;
+            printf( "%llu %d %d %u %u %lu\n", (unsigned long long)snap.timestampUs, snap.x, snap.y,
+                    snap.button, snap.position, (unsigned long)snap.samples );
+            fflush( stdout );
+        }
+
+        nanosleep( &period, 0 );
+    }
+
+    return 0;
+}
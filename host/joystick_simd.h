@@ -0,0 +1,483 @@
+/*
+Joystick Click batch kernels
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : any
+    Compiler         : gcc / clang ( C99 ), SSE2 / AVX2 intrinsics
+
+---
+
+Description :
+
+Batch versions of the driver's direction classifier, dead zone test and
+IIR filter for host replay and analysis of large sample sets. Samples are
+structure of arrays int8 buffers, X and Y in separate arrays.
+
+Every kernel has a scalar version built on the driver helpers and, when
+the compiler targets them ( -msse2, default on x86-64, and -mavx2 ),
+SSE2 and AVX2 versions giving the same bytes :
+
+- joystick_batchClassify() equals joystick_ctxClassify() for radius 0 and
+  joystick_ctxClassifyStable() with hysteresis 0 otherwise, given the
+  thresholds of the context ( joystick_setThresholds() clamps them ),
+- joystick_batchDeadzone() equals the dead zone test of
+  joystick_ctxClassifyStable() with hysteresis 0,
+- joystick_batchIir() equals joystick_ctxProcess() with
+  _JOYSTICK_FILTER_IIR on one axis, for many independent channels at
+  once ( time major, in[ t * channels + c ] ), state kept per channel.
+
+The functions without suffix select the widest compiled version.
+Include after __joystick_driver.c.
+
+*/
+
+#ifndef _JOYSTICK_SIMD_H_
+#define _JOYSTICK_SIMD_H_
+
+#include <stdint.h>
+
+#if defined( __SSE2__ ) || defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
+/* ------------------------------------------------------------------- SCALAR */
+
+/** Position of each sample, radius 0 disables the dead zone */
+static void joystick_batchClassifyScalar( const int8_t *x, const int8_t *y, uint8_t *position, uint32_t n,
+                                          uint8_t lo, uint8_t hi, uint8_t radius )
+{
+    uint32_t limit;
+    uint32_t i;
+
+    limit = (uint32_t)radius * radius;
+
+    for ( i = 0; i < n; i++ )
+    {
+        if ( (uint32_t)( (int16_t)x[ i ] * x[ i ] ) + (uint32_t)( (int16_t)y[ i ] * y[ i ] ) < limit )
+            position[ i ] = _JOYSTICK_POSITION_START;
+        else
+            position[ i ] = _JOYSTICK_ZONE_TABLE[ _joystick_zone( y[ i ], lo, hi ) ][ _joystick_zone( x[ i ], lo, hi ) ];
+    }
+}
+
+/** 1 for samples inside the dead zone, 0 otherwise */
+static void joystick_batchDeadzoneScalar( const int8_t *x, const int8_t *y, uint8_t *inside, uint32_t n, uint8_t radius )
+{
+    uint32_t limit;
+    uint32_t i;
+
+    limit = (uint32_t)radius * radius;
+
+    for ( i = 0; i < n; i++ )
+        inside[ i ] = (uint32_t)( (int16_t)x[ i ] * x[ i ] ) + (uint32_t)( (int16_t)y[ i ] * y[ i ] ) < limit;
+}
+
+/** Prime IIR channel states with their first samples, as the first call after joystick_setFilter() does */
+static void joystick_batchIirPrime( int16_t *state, const int8_t *first, uint32_t channels )
+{
+    uint32_t c;
+
+    for ( c = 0; c < channels; c++ )
+        state[ c ] = (int16_t)first[ c ] << 8;
+}
+
+/* Runs channels first .. channels - 1 through the driver's filter stage */
+static void _joystick_batchIirChannels( int16_t *state, const int8_t *in, int8_t *out, uint32_t channels,
+                                        uint32_t first, uint32_t steps, uint8_t shift )
+{
+    T_joystick_filter flt;
+    T_joystick_filterAxis axis;
+    uint32_t t;
+    uint32_t c;
+
+    flt.type = _JOYSTICK_FILTER_IIR;
+    flt.param1 = shift;
+    flt.index = 0;
+    flt.primed = 1;
+
+    for ( c = first; c < channels; c++ )
+    {
+        axis.state = state[ c ];
+
+        for ( t = 0; t < steps; t++ )
+            out[ (size_t)t * channels + c ] = _joystick_filterAxis( &flt, &axis, in[ (size_t)t * channels + c ] );
+
+        state[ c ] = axis.state;
+    }
+}
+
+/** IIR over steps time steps of channels channels, shift 1 .. 7 */
+static void joystick_batchIirScalar( int16_t *state, const int8_t *in, int8_t *out, uint32_t channels,
+                                     uint32_t steps, uint8_t shift )
+{
+    _joystick_batchIirChannels( state, in, out, channels, 0, steps, shift );
+}
+
+/* --------------------------------------------------------------------- SSE2 */
+
+#ifdef __SSE2__
+
+/* -( v > c ) per byte, c outside the int8 range folds to a constant */
+static __m128i _joystick_sse2Above( __m128i v, int16_t c )
+{
+    if ( c < -128 )
+        return _mm_set1_epi8( -1 );
+    if ( c > 126 )
+        return _mm_setzero_si128();
+
+    return _mm_cmpgt_epi8( v, _mm_set1_epi8( (char)c ) );
+}
+
+/* Zone 0 .. 4 per byte */
+static __m128i _joystick_sse2Zone( __m128i v, int16_t lo, int16_t hi )
+{
+    __m128i z;
+
+    z = _mm_add_epi8( _joystick_sse2Above( v, -hi ), _joystick_sse2Above( v, -lo ) );
+    z = _mm_add_epi8( z, _joystick_sse2Above( v, lo - 1 ) );
+    z = _mm_add_epi8( z, _joystick_sse2Above( v, hi - 1 ) );
+
+    return _mm_sub_epi8( _mm_setzero_si128(), z );
+}
+
+/* 0xFF per byte inside the dead zone, x^2 + y^2 fits 16 bits unsigned */
+static __m128i _joystick_sse2Inside( __m128i vx, __m128i vy, __m128i limit )
+{
+    __m128i xl;
+    __m128i xh;
+    __m128i yl;
+    __m128i yh;
+    __m128i zero;
+
+    zero = _mm_setzero_si128();
+    xl = _mm_srai_epi16( _mm_unpacklo_epi8( vx, vx ), 8 );
+    xh = _mm_srai_epi16( _mm_unpackhi_epi8( vx, vx ), 8 );
+    yl = _mm_srai_epi16( _mm_unpacklo_epi8( vy, vy ), 8 );
+    yh = _mm_srai_epi16( _mm_unpackhi_epi8( vy, vy ), 8 );
+
+    xl = _mm_add_epi16( _mm_mullo_epi16( xl, xl ), _mm_mullo_epi16( yl, yl ) );
+    xh = _mm_add_epi16( _mm_mullo_epi16( xh, xh ), _mm_mullo_epi16( yh, yh ) );
+
+    // limit - r2 saturates to 0 exactly when r2 >= limit
+    xl = _mm_cmpeq_epi16( _mm_subs_epu16( limit, xl ), zero );
+    xh = _mm_cmpeq_epi16( _mm_subs_epu16( limit, xh ), zero );
+
+    return _mm_xor_si128( _mm_packs_epi16( xl, xh ), _mm_set1_epi8( -1 ) );
+}
+
+static void joystick_batchClassifySse2( const int8_t *x, const int8_t *y, uint8_t *position, uint32_t n,
+                                        uint8_t lo, uint8_t hi, uint8_t radius )
+{
+    __m128i limit;
+    __m128i vx;
+    __m128i vy;
+    __m128i zy;
+    __m128i idx;
+    __m128i out;
+    uint32_t i;
+    uint8_t k;
+
+    limit = _mm_set1_epi16( (short)( (uint16_t)radius * radius ) );
+
+    for ( i = 0; i + 16 <= n; i += 16 )
+    {
+        vx = _mm_loadu_si128( (const __m128i*)( x + i ) );
+        vy = _mm_loadu_si128( (const __m128i*)( y + i ) );
+
+        zy = _joystick_sse2Zone( vy, lo, hi );
+        idx = _mm_add_epi8( _mm_add_epi8( zy, zy ), _mm_add_epi8( zy, zy ) );
+        idx = _mm_add_epi8( _mm_add_epi8( idx, zy ), _joystick_sse2Zone( vx, lo, hi ) );
+
+        // no byte shuffle in SSE2, select over the table entries
+        out = _mm_setzero_si128();
+
+        for ( k = 0; k < 25; k++ )
+        {
+            if ( _JOYSTICK_ZONE_TABLE[ k / 5 ][ k % 5 ] )
+                out = _mm_or_si128( out, _mm_and_si128( _mm_cmpeq_epi8( idx, _mm_set1_epi8( (char)k ) ),
+                                                        _mm_set1_epi8( (char)_JOYSTICK_ZONE_TABLE[ k / 5 ][ k % 5 ] ) ) );
+        }
+
+        if ( radius )
+            out = _mm_andnot_si128( _joystick_sse2Inside( vx, vy, limit ), out );
+
+        _mm_storeu_si128( (__m128i*)( position + i ), out );
+    }
+
+    joystick_batchClassifyScalar( x + i, y + i, position + i, n - i, lo, hi, radius );
+}
+
+static void joystick_batchDeadzoneSse2( const int8_t *x, const int8_t *y, uint8_t *inside, uint32_t n, uint8_t radius )
+{
+    __m128i limit;
+    __m128i m;
+    uint32_t i;
+
+    limit = _mm_set1_epi16( (short)( (uint16_t)radius * radius ) );
+
+    for ( i = 0; i + 16 <= n; i += 16 )
+    {
+        m = _joystick_sse2Inside( _mm_loadu_si128( (const __m128i*)( x + i ) ),
+                                  _mm_loadu_si128( (const __m128i*)( y + i ) ), limit );
+        _mm_storeu_si128( (__m128i*)( inside + i ), _mm_and_si128( m, _mm_set1_epi8( 1 ) ) );
+    }
+
+    joystick_batchDeadzoneScalar( x + i, y + i, inside + i, n - i, radius );
+}
+
+/*
+ * One IIR step on 8 channels in 16-bit lanes. The firmware computes
+ * ( ( v << 8 ) - state ) >> shift in 32 bits; v << 8 is a multiple of
+ * 1 << shift, so that equals ( v << 8 ) >> shift minus state >> shift
+ * rounded up, which fits 16 bits.
+ */
+static __m128i _joystick_sse2IirStep( __m128i *state, __m128i v16, __m128i count, __m128i mask )
+{
+    __m128i d;
+    __m128i exact;
+
+    exact = _mm_cmpeq_epi16( _mm_and_si128( *state, mask ), _mm_setzero_si128() );
+    d = _mm_sub_epi16( _mm_sra_epi16( v16, count ), _mm_sra_epi16( *state, count ) );
+    d = _mm_sub_epi16( _mm_add_epi16( d, _mm_set1_epi16( -1 ) ), exact );
+
+    *state = _mm_add_epi16( *state, d );
+
+    return _mm_srai_epi16( _mm_add_epi16( *state, _mm_set1_epi16( 128 ) ), 8 );
+}
+
+static void joystick_batchIirSse2( int16_t *state, const int8_t *in, int8_t *out, uint32_t channels,
+                                   uint32_t steps, uint8_t shift )
+{
+    __m128i count;
+    __m128i mask;
+    __m128i zero;
+    __m128i s0;
+    __m128i s1;
+    __m128i v;
+    __m128i o0;
+    __m128i o1;
+    uint32_t c;
+    uint32_t t;
+
+    count = _mm_cvtsi32_si128( shift );
+    mask = _mm_set1_epi16( (short)( ( 1 << shift ) - 1 ) );
+    zero = _mm_setzero_si128();
+
+    for ( c = 0; c + 16 <= channels; c += 16 )
+    {
+        s0 = _mm_loadu_si128( (const __m128i*)( state + c ) );
+        s1 = _mm_loadu_si128( (const __m128i*)( state + c + 8 ) );
+
+        for ( t = 0; t < steps; t++ )
+        {
+            v = _mm_loadu_si128( (const __m128i*)( in + (size_t)t * channels + c ) );
+
+            // bytes to the high half, v << 8 in each lane
+            o0 = _joystick_sse2IirStep( &s0, _mm_unpacklo_epi8( zero, v ), count, mask );
+            o1 = _joystick_sse2IirStep( &s1, _mm_unpackhi_epi8( zero, v ), count, mask );
+
+            _mm_storeu_si128( (__m128i*)( out + (size_t)t * channels + c ), _mm_packs_epi16( o0, o1 ) );
+        }
+
+        _mm_storeu_si128( (__m128i*)( state + c ), s0 );
+        _mm_storeu_si128( (__m128i*)( state + c + 8 ), s1 );
+    }
+
+    _joystick_batchIirChannels( state, in, out, channels, c, steps, shift );
+}
+
+#endif
+
+/* --------------------------------------------------------------------- AVX2 */
+
+#ifdef __AVX2__
+
+static __m256i _joystick_avx2Above( __m256i v, int16_t c )
+{
+    if ( c < -128 )
+        return _mm256_set1_epi8( -1 );
+    if ( c > 126 )
+        return _mm256_setzero_si256();
+
+    return _mm256_cmpgt_epi8( v, _mm256_set1_epi8( (char)c ) );
+}
+
+static __m256i _joystick_avx2Zone( __m256i v, int16_t lo, int16_t hi )
+{
+    __m256i z;
+
+    z = _mm256_add_epi8( _joystick_avx2Above( v, -hi ), _joystick_avx2Above( v, -lo ) );
+    z = _mm256_add_epi8( z, _joystick_avx2Above( v, lo - 1 ) );
+    z = _mm256_add_epi8( z, _joystick_avx2Above( v, hi - 1 ) );
+
+    return _mm256_sub_epi8( _mm256_setzero_si256(), z );
+}
+
+static __m256i _joystick_avx2Inside( __m256i vx, __m256i vy, __m256i limit )
+{
+    __m256i xl;
+    __m256i xh;
+    __m256i yl;
+    __m256i yh;
+    __m256i zero;
+
+    zero = _mm256_setzero_si256();
+    xl = _mm256_cvtepi8_epi16( _mm256_castsi256_si128( vx ) );
+    xh = _mm256_cvtepi8_epi16( _mm256_extracti128_si256( vx, 1 ) );
+    yl = _mm256_cvtepi8_epi16( _mm256_castsi256_si128( vy ) );
+    yh = _mm256_cvtepi8_epi16( _mm256_extracti128_si256( vy, 1 ) );
+
+    xl = _mm256_add_epi16( _mm256_mullo_epi16( xl, xl ), _mm256_mullo_epi16( yl, yl ) );
+    xh = _mm256_add_epi16( _mm256_mullo_epi16( xh, xh ), _mm256_mullo_epi16( yh, yh ) );
+
+    xl = _mm256_cmpeq_epi16( _mm256_subs_epu16( limit, xl ), zero );
+    xh = _mm256_cmpeq_epi16( _mm256_subs_epu16( limit, xh ), zero );
+
+    // packs works per 128-bit lane, restore the sample order
+    xl = _mm256_permute4x64_epi64( _mm256_packs_epi16( xl, xh ), 0xD8 );
+
+    return _mm256_xor_si256( xl, _mm256_set1_epi8( -1 ) );
+}
+
+static void joystick_batchClassifyAvx2( const int8_t *x, const int8_t *y, uint8_t *position, uint32_t n,
+                                        uint8_t lo, uint8_t hi, uint8_t radius )
+{
+    uint8_t table[ 32 ];
+    __m256i lower;
+    __m256i upper;
+    __m256i limit;
+    __m256i vx;
+    __m256i vy;
+    __m256i zy;
+    __m256i idx;
+    __m256i high;
+    __m256i out;
+    uint32_t i;
+    uint8_t k;
+
+    for ( k = 0; k < 32; k++ )
+        table[ k ] = k < 25 ? _JOYSTICK_ZONE_TABLE[ k / 5 ][ k % 5 ] : 0;
+
+    // the byte shuffle looks up 16 entries per lane, entries 16 .. 24 come from the second table
+    lower = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)table ) );
+    upper = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)( table + 16 ) ) );
+    limit = _mm256_set1_epi16( (short)( (uint16_t)radius * radius ) );
+
+    for ( i = 0; i + 32 <= n; i += 32 )
+    {
+        vx = _mm256_loadu_si256( (const __m256i*)( x + i ) );
+        vy = _mm256_loadu_si256( (const __m256i*)( y + i ) );
+
+        zy = _joystick_avx2Zone( vy, lo, hi );
+        idx = _mm256_add_epi8( _mm256_add_epi8( zy, zy ), _mm256_add_epi8( zy, zy ) );
+        idx = _mm256_add_epi8( _mm256_add_epi8( idx, zy ), _joystick_avx2Zone( vx, lo, hi ) );
+
+        // a set top bit zeroes the shuffle result
+        high = _mm256_cmpgt_epi8( idx, _mm256_set1_epi8( 15 ) );
+        out = _mm256_or_si256(
+                  _mm256_shuffle_epi8( lower, _mm256_or_si256( idx, _mm256_and_si256( high, _mm256_set1_epi8( (char)0x80 ) ) ) ),
+                  _mm256_shuffle_epi8( upper, _mm256_or_si256( _mm256_sub_epi8( idx, _mm256_set1_epi8( 16 ) ),
+                                                               _mm256_andnot_si256( high, _mm256_set1_epi8( (char)0x80 ) ) ) ) );
+
+        if ( radius )
+            out = _mm256_andnot_si256( _joystick_avx2Inside( vx, vy, limit ), out );
+
+        _mm256_storeu_si256( (__m256i*)( position + i ), out );
+    }
+
+    joystick_batchClassifyScalar( x + i, y + i, position + i, n - i, lo, hi, radius );
+}
+
+static void joystick_batchDeadzoneAvx2( const int8_t *x, const int8_t *y, uint8_t *inside, uint32_t n, uint8_t radius )
+{
+    __m256i limit;
+    __m256i m;
+    uint32_t i;
+
+    limit = _mm256_set1_epi16( (short)( (uint16_t)radius * radius ) );
+
+    for ( i = 0; i + 32 <= n; i += 32 )
+    {
+        m = _joystick_avx2Inside( _mm256_loadu_si256( (const __m256i*)( x + i ) ),
+                                  _mm256_loadu_si256( (const __m256i*)( y + i ) ), limit );
+        _mm256_storeu_si256( (__m256i*)( inside + i ), _mm256_and_si256( m, _mm256_set1_epi8( 1 ) ) );
+    }
+
+    joystick_batchDeadzoneScalar( x + i, y + i, inside + i, n - i, radius );
+}
+
+/* IIR step on 16 channels, see _joystick_sse2IirStep() */
+static __m256i _joystick_avx2IirStep( __m256i *state, __m256i v16, __m128i count, __m256i mask )
+{
+    __m256i d;
+    __m256i exact;
+
+    exact = _mm256_cmpeq_epi16( _mm256_and_si256( *state, mask ), _mm256_setzero_si256() );
+    d = _mm256_sub_epi16( _mm256_sra_epi16( v16, count ), _mm256_sra_epi16( *state, count ) );
+    d = _mm256_sub_epi16( _mm256_add_epi16( d, _mm256_set1_epi16( -1 ) ), exact );
+
+    *state = _mm256_add_epi16( *state, d );
+
+    return _mm256_srai_epi16( _mm256_add_epi16( *state, _mm256_set1_epi16( 128 ) ), 8 );
+}
+
+static void joystick_batchIirAvx2( int16_t *state, const int8_t *in, int8_t *out, uint32_t channels,
+                                   uint32_t steps, uint8_t shift )
+{
+    __m128i count;
+    __m256i mask;
+    __m256i s0;
+    __m256i s1;
+    __m256i v;
+    __m256i o;
+    uint32_t c;
+    uint32_t t;
+
+    count = _mm_cvtsi32_si128( shift );
+    mask = _mm256_set1_epi16( (short)( ( 1 << shift ) - 1 ) );
+
+    for ( c = 0; c + 32 <= channels; c += 32 )
+    {
+        s0 = _mm256_loadu_si256( (const __m256i*)( state + c ) );
+        s1 = _mm256_loadu_si256( (const __m256i*)( state + c + 16 ) );
+
+        for ( t = 0; t < steps; t++ )
+        {
+            v = _mm256_loadu_si256( (const __m256i*)( in + (size_t)t * channels + c ) );
+
+            o = _mm256_packs_epi16(
+                    _joystick_avx2IirStep( &s0, _mm256_slli_epi16( _mm256_cvtepi8_epi16( _mm256_castsi256_si128( v ) ), 8 ), count, mask ),
+                    _joystick_avx2IirStep( &s1, _mm256_slli_epi16( _mm256_cvtepi8_epi16( _mm256_extracti128_si256( v, 1 ) ), 8 ), count, mask ) );
+
+            _mm256_storeu_si256( (__m256i*)( out + (size_t)t * channels + c ), _mm256_permute4x64_epi64( o, 0xD8 ) );
+        }
+
+        _mm256_storeu_si256( (__m256i*)( state + c ), s0 );
+        _mm256_storeu_si256( (__m256i*)( state + c + 16 ), s1 );
+    }
+
+    _joystick_batchIirChannels( state, in, out, channels, c, steps, shift );
+}
+
+#endif
+
+/* ----------------------------------------------------------------- DISPATCH */
+
+#if defined( __AVX2__ )
+#define joystick_batchClassify      joystick_batchClassifyAvx2
+#define joystick_batchDeadzone      joystick_batchDeadzoneAvx2
+#define joystick_batchIir           joystick_batchIirAvx2
+#elif defined( __SSE2__ )
+#define joystick_batchClassify      joystick_batchClassifySse2
+#define joystick_batchDeadzone      joystick_batchDeadzoneSse2
+#define joystick_batchIir           joystick_batchIirSse2
+#else
+#define joystick_batchClassify      joystick_batchClassifyScalar
+#define joystick_batchDeadzone      joystick_batchDeadzoneScalar
+#define joystick_batchIir           joystick_batchIirScalar
+#endif
+
+#endif
@@ -0,0 +1,387 @@
+/*
+Joystick Click batch kernel check and benchmark
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build ( SSE2 )   : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_simdbench.c -o joystick_simdbench
+    Build ( AVX2 )   : cc -std=c99 -O2 -mavx2 -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_simdbench.c -o joystick_simdbench_avx2
+
+---
+
+Description :
+
+Checks the kernels of joystick_simd.h, then times them.
+
+- the scalar kernels against the driver functions they batch,
+- every driver filter on full-scale alternation and steps : the step
+  response is monotonic and settles on the held value,
+- every compiled SIMD kernel against the scalar one, on all 65,536
+  ( x, y ) pairs for threshold and radius sets including the int8
+  range limits, and on random streams for every IIR shift,
+- throughput of each kernel in M samples/s.
+
+- joystick_simdbench [samples]      - benchmark size ( default 16,777,216 )
+
+Exits with 2 when any output differs.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "__joystick_driver.c"
+#include "joystick_simd.h"
+
+#define CHANNELS    64
+
+typedef void ( *T_classifyFp )( const int8_t*, const int8_t*, uint8_t*, uint32_t, uint8_t, uint8_t, uint8_t );
+typedef void ( *T_deadzoneFp )( const int8_t*, const int8_t*, uint8_t*, uint32_t, uint8_t );
+typedef void ( *T_iirFp )( int16_t*, const int8_t*, int8_t*, uint32_t, uint32_t, uint8_t );
+
+typedef struct
+{
+    const char          *name;
+    T_classifyFp        classify;
+    T_deadzoneFp        deadzone;
+    T_iirFp             iir;
+
+}T_kernelSet;
+
+static const T_kernelSet kernels[] =
+{
+    { "scalar", joystick_batchClassifyScalar, joystick_batchDeadzoneScalar, joystick_batchIirScalar },
+#ifdef __SSE2__
+    { "sse2",   joystick_batchClassifySse2,   joystick_batchDeadzoneSse2,   joystick_batchIirSse2 },
+#endif
+#ifdef __AVX2__
+    { "avx2",   joystick_batchClassifyAvx2,   joystick_batchDeadzoneAvx2,   joystick_batchIirAvx2 },
+#endif
+};
+
+#define KERNELS     ( sizeof( kernels ) / sizeof( kernels[ 0 ] ) )
+
+/* Threshold / radius sets, last ones at the int8 range limits */
+static const uint8_t params[][ 3 ] =
+{
+    {  20,  60,   0 },
+    {  20,  60,  20 },
+    {  10, 100,  35 },
+    {   0,   0,   0 },
+    {   0, 127, 181 },
+    { 127, 128, 182 },
+    { 128, 255, 255 },
+    { 200, 255,   1 }
+};
+
+static uint32_t seed = 12345;
+
+static int8_t randomByte( void )
+{
+    seed = seed * 1103515245u + 12345u;
+
+    return (int8_t)( seed >> 16 );
+}
+
+static double now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static T_hal_simBus bus;
+static T_hal_simDevice dev;
+static T_hal_gpioObj gpio;
+
+static void contextInit( T_joystick_ctx *ctx )
+{
+    joystick_ctxI2cDriverInit( ctx, (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, _JOYSTICK_I2C_ADDRESS_0 );
+}
+
+/* Scalar kernels against the driver API */
+static unsigned long checkScalar( void )
+{
+    T_joystick_ctx ctx;
+    static int8_t x[ 65536 ];
+    static int8_t y[ 65536 ];
+    static uint8_t out[ 65536 ];
+    static int8_t in[ 256 * CHANNELS ];
+    static int8_t filtered[ 256 * CHANNELS ];
+    int16_t state[ CHANNELS ];
+    unsigned long errors;
+    uint32_t i;
+    uint32_t c;
+    uint8_t p;
+    uint8_t shift;
+    int8_t ox;
+    int8_t oy;
+
+    errors = 0;
+
+    for ( i = 0; i < 65536; i++ )
+    {
+        x[ i ] = (int8_t)( i & 0xFF );
+        y[ i ] = (int8_t)( i >> 8 );
+    }
+
+    contextInit( &ctx );
+
+    for ( p = 0; p < sizeof( params ) / sizeof( params[ 0 ] ); p++ )
+    {
+        joystick_ctxSetThresholds( &ctx, params[ p ][ 0 ], params[ p ][ 1 ] );
+        joystick_ctxSetDeadzone( &ctx, params[ p ][ 2 ], 0 );
+        joystick_batchClassifyScalar( x, y, out, 65536, ctx.lowThreshold, ctx.highThreshold, params[ p ][ 2 ] );
+
+        for ( i = 0; i < 65536; i++ )
+        {
+            if ( out[ i ] != ( params[ p ][ 2 ] ? joystick_ctxClassifyStable( &ctx, x[ i ], y[ i ] ) : joystick_ctxClassify( &ctx, x[ i ], y[ i ] ) ) )
+                errors++;
+        }
+    }
+
+    for ( shift = 1; shift <= 7; shift++ )
+    {
+        for ( i = 0; i < 256 * CHANNELS; i++ )
+            in[ i ] = randomByte();
+
+        joystick_batchIirPrime( state, in, CHANNELS );
+        joystick_batchIirScalar( state, in, filtered, CHANNELS, 256, shift );
+
+        // one context per channel, X carries the channel
+        for ( c = 0; c < CHANNELS; c++ )
+        {
+            contextInit( &ctx );
+            joystick_ctxSetFilter( &ctx, _JOYSTICK_FILTER_IIR, shift, 0 );
+
+            for ( i = 0; i < 256; i++ )
+            {
+                ox = in[ i * CHANNELS + c ];
+                oy = 0;
+                joystick_ctxProcess( &ctx, &ox, &oy );
+
+                if ( ox != filtered[ i * CHANNELS + c ] )
+                    errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+/* Filter settings of the full-scale check : type, param1, param2 */
+static const uint8_t filters[][ 3 ] =
+{
+    { 1, 1, 0 }, { 1, 2, 0 }, { 1, 7, 0 },
+    { 2, 0, 0 }, { 3, 0, 0 },
+    { 4, 16, 32 }, { 4, 0, 255 }, { 4, 255, 255 }, { 4, 64, 8 }
+};
+
+/* Runs value n times through the filter, counts outputs moving against direction ( 0 : any ) */
+static unsigned long filterHold( T_joystick_ctx *ctx, int8_t value, uint32_t n, int8_t direction, int8_t *out )
+{
+    unsigned long errors;
+    int8_t ox;
+    int8_t oy;
+
+    errors = 0;
+
+    while ( n-- )
+    {
+        ox = value;
+        oy = (int8_t)-value;
+        joystick_ctxProcess( ctx, &ox, &oy );
+
+        if ( ( direction > 0 && ox < *out ) || ( direction < 0 && ox > *out ) )
+            errors++;
+
+        *out = ox;
+    }
+
+    return errors;
+}
+
+/* Every filter on full-scale alternation and steps : monotonic step response, settles on the held value */
+static unsigned long checkFilters( void )
+{
+    T_joystick_ctx ctx;
+    unsigned long errors;
+    uint32_t f;
+    uint32_t i;
+    int8_t out;
+
+    errors = 0;
+
+    for ( f = 0; f < sizeof( filters ) / sizeof( filters[ 0 ] ); f++ )
+    {
+        contextInit( &ctx );
+        joystick_ctxSetFilter( &ctx, filters[ f ][ 0 ], filters[ f ][ 1 ], filters[ f ][ 2 ] );
+        out = 0;
+
+        for ( i = 0; i < 64; i++ )
+            filterHold( &ctx, ( i & 1 ) ? -128 : 127, 1, 0, &out );
+
+        errors += filterHold( &ctx, 127, 2048, 1, &out ) + ( out != 127 );
+        errors += filterHold( &ctx, -128, 2048, -1, &out ) + ( out != -128 );
+        errors += filterHold( &ctx, 0, 2048, 1, &out ) + ( out != 0 );
+    }
+
+    return errors;
+}
+
+/* SIMD kernels against the scalar ones */
+static unsigned long checkSimd( const T_kernelSet *k )
+{
+    static int8_t x[ 65536 + 31 ];
+    static int8_t y[ 65536 + 31 ];
+    static uint8_t ref[ 65536 + 31 ];
+    static uint8_t out[ 65536 + 31 ];
+    static int8_t in[ 1000 * ( CHANNELS + 7 ) ];
+    static int8_t refIir[ 1000 * ( CHANNELS + 7 ) ];
+    static int8_t outIir[ 1000 * ( CHANNELS + 7 ) ];
+    int16_t refState[ CHANNELS + 7 ];
+    int16_t state[ CHANNELS + 7 ];
+    unsigned long errors;
+    uint32_t channels;
+    uint32_t n;
+    uint32_t i;
+    uint8_t p;
+    uint8_t shift;
+
+    errors = 0;
+
+    // odd length exercises the scalar tail
+    n = 65536 + 31;
+
+    for ( i = 0; i < n; i++ )
+    {
+        x[ i ] = (int8_t)( i & 0xFF );
+        y[ i ] = (int8_t)( ( i >> 8 ) ^ ( i & 1 ) );
+    }
+
+    for ( p = 0; p < sizeof( params ) / sizeof( params[ 0 ] ); p++ )
+    {
+        joystick_batchClassifyScalar( x, y, ref, n, params[ p ][ 0 ], params[ p ][ 1 ], params[ p ][ 2 ] );
+        k->classify( x, y, out, n, params[ p ][ 0 ], params[ p ][ 1 ], params[ p ][ 2 ] );
+        errors += memcmp( ref, out, n ) != 0;
+
+        joystick_batchDeadzoneScalar( x, y, ref, n, params[ p ][ 2 ] );
+        k->deadzone( x, y, out, n, params[ p ][ 2 ] );
+        errors += memcmp( ref, out, n ) != 0;
+    }
+
+    for ( channels = CHANNELS; channels <= CHANNELS + 7; channels += 7 )
+    {
+        for ( shift = 1; shift <= 7; shift++ )
+        {
+            // random values with runs of the extremes
+            for ( i = 0; i < 1000 * channels; i++ )
+                in[ i ] = ( i / channels ) % 200 < 20 ? ( ( i / channels ) % 2 ? 127 : -128 ) : randomByte();
+
+            joystick_batchIirPrime( refState, in, channels );
+            memcpy( state, refState, sizeof( state ) );
+
+            joystick_batchIirScalar( refState, in, refIir, channels, 1000, shift );
+            k->iir( state, in, outIir, channels, 1000, shift );
+
+            errors += memcmp( refIir, outIir, 1000 * channels ) != 0;
+            errors += memcmp( refState, state, channels * sizeof( int16_t ) ) != 0;
+        }
+    }
+
+    return errors;
+}
+
+int main( int argc, char **argv )
+{
+    int8_t *x;
+    int8_t *y;
+    uint8_t *out;
+    int8_t *filtered;
+    int16_t state[ CHANNELS ];
+    unsigned long errors;
+    unsigned long e;
+    uint32_t n;
+    uint32_t i;
+    uint32_t k;
+    double t;
+    double rate[ 3 ];
+    int8_t walkX;
+    int8_t walkY;
+
+    n = argc > 1 ? (uint32_t)atol( argv[ 1 ] ) : 16777216u;
+    n -= n % CHANNELS;
+
+    hal_simBusInit( &bus, 400000 );
+    hal_simDeviceInit( &dev, _JOYSTICK_I2C_ADDRESS_0, 0, 0, 0 );
+    hal_simBusAttach( &bus, &dev );
+    hal_simGpioObj( &gpio, 0, &dev );
+
+    errors = checkScalar();
+    printf( "%-8s against driver    : %s\n", "scalar", errors ? "MISMATCH" : "ok" );
+
+    e = checkFilters();
+    printf( "%-8s full-scale steps  : %s\n", "filters", e ? "MISMATCH" : "ok" );
+    errors += e;
+
+    for ( k = 1; k < KERNELS; k++ )
+    {
+        e = checkSimd( &kernels[ k ] );
+        printf( "%-8s against scalar    : %s\n", kernels[ k ].name, e ? "MISMATCH" : "ok" );
+        errors += e;
+    }
+
+    x = (int8_t*)malloc( n );
+    y = (int8_t*)malloc( n );
+    out = (uint8_t*)malloc( n );
+    filtered = (int8_t*)malloc( n );
+
+    // random walk, a stick moving around rather than white noise
+    walkX = 0;
+    walkY = 0;
+
+    for ( i = 0; i < n; i++ )
+    {
+        walkX = (int8_t)( walkX + ( randomByte() >> 5 ) );
+        walkY = (int8_t)( walkY + ( randomByte() >> 5 ) );
+        x[ i ] = walkX;
+        y[ i ] = walkY;
+    }
+
+    printf( "\n%u samples, M samples/s ( IIR : %u channels )\n\n", n, CHANNELS );
+    printf( "%-8s %10s %10s %10s\n", "kernel", "classify", "deadzone", "iir" );
+
+    for ( k = 0; k < KERNELS; k++ )
+    {
+        t = now();
+        kernels[ k ].classify( x, y, out, n, _JOYSTICK_DEFAULT_LOW_THRESHOLD, _JOYSTICK_DEFAULT_HIGH_THRESHOLD, 20 );
+        rate[ 0 ] = n / ( now() - t ) * 1e-6;
+
+        t = now();
+        kernels[ k ].deadzone( x, y, out, n, 20 );
+        rate[ 1 ] = n / ( now() - t ) * 1e-6;
+
+        joystick_batchIirPrime( state, x, CHANNELS );
+        t = now();
+        kernels[ k ].iir( state, x, filtered, CHANNELS, n / CHANNELS, _JOYSTICK_FILTER_DEFAULT_SHIFT );
+        rate[ 2 ] = n / ( now() - t ) * 1e-6;
+
+        printf( "%-8s %10.1f %10.1f %10.1f\n", kernels[ k ].name, rate[ 0 ], rate[ 1 ], rate[ 2 ] );
+    }
+
+    free( x );
+    free( y );
+    free( out );
+    free( filtered );
+
+    return errors ? 2 : 0;
+}
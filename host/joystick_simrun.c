@@ -0,0 +1,132 @@
+/*
+Joystick Click simulated run
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_simrun.c -o joystick_simrun
+
+---
+
+Description :
+
+Runs the unmodified driver against two simulated AS5013 Hall ICs
+( _JOYSTICK_I2C_ADDRESS_0 and _JOYSTICK_I2C_ADDRESS_1 ) on one 400 kHz bus,
+each following a scripted stick trajectory, and reports the direction
+changes seen by joystick_ctxGetPosition() together with the virtual
+bus time and I2C cost of one sample.
+
+- joystick_simrun [samples]         - number of samples per stick ( default 1000 )
+
+Add -D__JOYSTICK_STATS__ to the build to also print the driver side bus cost counters.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "__joystick_driver.c"
+
+/* Full circle in 800 ms followed by a button press */
+static const T_hal_simPoint circlePath[] =
+{
+    {      0,    0,    0, 0 },
+    { 100000,  100,    0, 0 },
+    { 200000,  100,  100, 0 },
+    { 300000,    0,  100, 0 },
+    { 400000, -100,  100, 0 },
+    { 500000, -100,    0, 0 },
+    { 600000, -100, -100, 0 },
+    { 700000,    0, -100, 0 },
+    { 800000,  100, -100, 0 },
+    { 900000,    0,    0, 1 },
+    { 950000,    0,    0, 0 }
+};
+
+/* Slow drift around the center */
+static const T_hal_simPoint driftPath[] =
+{
+    {      0,   0,   0, 0 },
+    { 400000,  25,  -5, 0 },
+    { 800000, -25,   5, 0 }
+};
+
+static const char *positionName[ 9 ] =
+{
+    "Start", "Top", "Top-Right", "Right", "Bottom-Right",
+    "Bottom", "Bottom-Left", "Left", "Top-Left"
+};
+
+int main( int argc, char **argv )
+{
+    T_hal_simBus bus;
+    T_hal_simDevice dev[ 2 ];
+    T_hal_gpioObj gpio[ 2 ];
+    T_joystick_ctx ctx[ 2 ];
+    uint8_t last[ 2 ] = { 0, 0 };
+    uint64_t startUs;
+    uint32_t startStarts;
+    uint32_t startBytes;
+    long samples;
+    long i;
+    int k;
+
+    samples = argc > 1 ? atol( argv[ 1 ] ) : 1000;
+
+    hal_simBusInit( &bus, 400000 );
+
+    hal_simDeviceInit( &dev[ 0 ], _JOYSTICK_I2C_ADDRESS_0, circlePath, sizeof( circlePath ) / sizeof( circlePath[ 0 ] ), 1 );
+    hal_simDeviceInit( &dev[ 1 ], _JOYSTICK_I2C_ADDRESS_1, driftPath, sizeof( driftPath ) / sizeof( driftPath[ 0 ] ), 1 );
+
+    for ( k = 0; k < 2; k++ )
+    {
+        hal_simBusAttach( &bus, &dev[ k ] );
+        hal_simGpioObj( &gpio[ k ], k, &dev[ k ] );
+        joystick_ctxI2cDriverInit( &ctx[ k ], (T_JOYSTICK_P)&gpio[ k ], (T_JOYSTICK_P)&bus, dev[ k ].address );
+        joystick_ctxSetDefaultConfiguration( &ctx[ k ] );
+    }
+
+    startUs = hal_simTimeUs;
+    startStarts = bus.starts;
+    startBytes = bus.bytes;
+
+    for ( i = 0; i < samples; i++ )
+    {
+        for ( k = 0; k < 2; k++ )
+        {
+            uint8_t position = joystick_ctxGetPosition( &ctx[ k ] );
+
+            if ( position != last[ k ] )
+            {
+                printf( "%10llu us  stick %d  %s\n", (unsigned long long)hal_simTimeUs, k, positionName[ position ] );
+                last[ k ] = position;
+            }
+        }
+
+        Delay_1ms();
+    }
+
+    printf( "\n%ld samples per stick\n", samples );
+    printf( "bus time per sample : %.1f us\n",
+            (double)( hal_simTimeUs - startUs - (uint64_t)samples * 1000 ) / ( 2.0 * samples ) );
+    printf( "START per sample    : %.2f\n", (double)( bus.starts - startStarts ) / ( 2.0 * samples ) );
+    printf( "bytes per sample    : %.2f\n", (double)( bus.bytes - startBytes ) / ( 2.0 * samples ) );
+    printf( "NACKs               : %lu\n", (unsigned long)bus.nacks );
+
+#ifdef __JOYSTICK_STATS__
+    for ( k = 0; k < 2; k++ )
+    {
+        T_joystick_stats stats;
+
+        joystick_ctxGetStats( &ctx[ k ], &stats );
+        printf( "stick %d driver stats : %lu transactions, %lu bytes, %lu START, %lu RESTART, %lu STOP, %lu us waits\n", k,
+                (unsigned long)stats.transactions, (unsigned long)stats.bytes, (unsigned long)stats.starts,
+                (unsigned long)stats.restarts, (unsigned long)stats.stops, (unsigned long)stats.delayUs );
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+Joystick Click i2c-dev stand-in
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+
+---
+
+Description :
+
+Replaces the I2C_RDWR ioctl of the Linux HAL ( T_hal_linuxBus.ioctlFp )
+with a register file of the AS5013 at 0x40, for the host tools to run
+without hardware :
+
+- X / Y walk a square of side 160 in 400 measurements,
+- free running : reading X ( 0x10 ) takes a new measurement,
+- clocked : joystick_standInMeasure() takes one, e.g. from a timer,
+  and INT ( joystick_standInIntGet(), active low ) is asserted while
+  interrupts are enabled ( Control 1 bit 2 ) and the measurement has not
+  been read; reading Y_res_int ( 0x11 ) releases it.
+
+Include after __joystick_driver.c built with __HAL_LINUX__.
+
+*/
+
+#ifndef _JOYSTICK_STANDIN_H_
+#define _JOYSTICK_STANDIN_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+static uint8_t  joystick_standInRegs[ 0x30 ];
+static uint8_t  joystick_standInPointer;
+static uint8_t  joystick_standInClocked;
+static uint8_t  joystick_standInPending;
+static uint32_t joystick_standInSamples;
+
+static inline void joystick_standInInit( uint8_t clocked )
+{
+    memset( joystick_standInRegs, 0, sizeof( joystick_standInRegs ) );
+
+    joystick_standInRegs[ 0x0C ] = 0x0C;
+    joystick_standInRegs[ 0x0D ] = 0x0D;
+    joystick_standInPointer = 0;
+    joystick_standInClocked = clocked;
+    joystick_standInPending = 0;
+    joystick_standInSamples = 0;
+}
+
+/** Take the next measurement */
+static inline void joystick_standInMeasure( void )
+{
+    uint32_t step;
+    int16_t a;
+
+    step = joystick_standInSamples++ % 400;
+    a = (int16_t)( step % 100 ) * 160 / 100 - 80;
+
+    if ( step < 100 )
+    {
+        joystick_standInRegs[ 0x10 ] = (uint8_t)a;
+        joystick_standInRegs[ 0x11 ] = (uint8_t)-80;
+    }
+    else if ( step < 200 )
+    {
+        joystick_standInRegs[ 0x10 ] = 80;
+        joystick_standInRegs[ 0x11 ] = (uint8_t)a;
+    }
+    else if ( step < 300 )
+    {
+        joystick_standInRegs[ 0x10 ] = (uint8_t)-a;
+        joystick_standInRegs[ 0x11 ] = 80;
+    }
+    else
+    {
+        joystick_standInRegs[ 0x10 ] = (uint8_t)-80;
+        joystick_standInRegs[ 0x11 ] = (uint8_t)-a;
+    }
+
+    joystick_standInPending = 1;
+}
+
+/** INT pin level, for gpioGet[ __INT_PIN_INPUT__ ] of the GPIO object */
+static inline uint8_t joystick_standInIntGet()
+{
+    return !( joystick_standInPending && ( joystick_standInRegs[ 0x0F ] & 0x04 ) );
+}
+
+static inline int joystick_standInIoctl( int fd, unsigned long request, void *arg )
+{
+    struct i2c_rdwr_ioctl_data *rdwr;
+    struct i2c_msg *msg;
+    uint32_t m;
+    uint16_t i;
+
+    (void)fd;
+    rdwr = (struct i2c_rdwr_ioctl_data*)arg;
+
+    if ( request != I2C_RDWR )
+    {
+        errno = ENOTTY;
+        return -1;
+    }
+
+    for ( m = 0; m < rdwr->nmsgs; m++ )
+    {
+        msg = &rdwr->msgs[ m ];
+
+        if ( msg->addr != 0x40 )
+        {
+            errno = ENXIO;
+            return -1;
+        }
+
+        for ( i = 0; i < msg->len; i++ )
+        {
+            if ( msg->flags & I2C_M_RD )
+            {
+                if ( joystick_standInPointer == 0x10 && !joystick_standInClocked )
+                    joystick_standInMeasure();
+                if ( joystick_standInPointer == 0x11 )
+                    joystick_standInPending = 0;
+
+                msg->buf[ i ] = joystick_standInRegs[ joystick_standInPointer ];
+                joystick_standInPointer = ( joystick_standInPointer + 1 ) % 0x30;
+            }
+            else if ( i == 0 )
+            {
+                joystick_standInPointer = msg->buf[ 0 ] % 0x30;
+            }
+            else
+            {
+                // Soft_rst reads back cleared
+                joystick_standInRegs[ joystick_standInPointer ] = joystick_standInPointer == 0x0F ? msg->buf[ i ] & 0x7F : msg->buf[ i ];
+                joystick_standInPointer = ( joystick_standInPointer + 1 ) % 0x30;
+            }
+        }
+    }
+
+    return (int)rdwr->nmsgs;
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+Joystick Click telemetry encoder / decoder
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -D__JOYSTICK_TELEMETRY__ -I../library -I../library/HAL joystick_telemetry.c -o joystick_telemetry
+
+---
+
+Description :
+
+Encodes samples of a simulated stick into the driver's binary telemetry
+stream, or decodes a captured stream ( e.g. from the UART ) back into
+timestamped samples. Both directions use the driver code, so a capture
+decoded here is exactly what the firmware encoded.
+
+- joystick_telemetry enc [samples] [periodUs] > stream.bin   - encode samples taken every periodUs ( default 1000 samples, 2000 us )
+- joystick_telemetry dec [stream.bin] > samples.csv          - decode file or stdin to CSV : timestamp_us, x, y, button
+
+Statistics ( bytes per sample, line rate needed, decode errors ) go to stderr.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "__joystick_driver.c"
+
+/* Figure eight with button clicks */
+static const T_hal_simPoint eightPath[] =
+{
+    {      0,    0,    0, 0 },
+    { 150000,   90,   60, 0 },
+    { 300000,    0,    0, 1 },
+    { 320000,    0,    0, 0 },
+    { 450000,  -90,  -60, 0 },
+    { 600000,    0,    0, 0 },
+    { 750000,   90,  -60, 0 },
+    { 900000,    0,    0, 1 },
+    { 920000,    0,    0, 0 },
+    {1050000,  -90,   60, 0 },
+    {1200000,    0,    0, 0 }
+};
+
+#define BATCH   32
+
+static int encode( long samples, uint32_t periodUs )
+{
+    T_hal_simBus bus;
+    T_hal_simDevice dev;
+    T_hal_gpioObj gpio;
+    T_joystick_record batch[ BATCH ];
+    uint8_t frame[ _JOYSTICK_TELEMETRY_FRAME_MAX ];
+    uint32_t base;
+    unsigned long bytes;
+    long done;
+    uint8_t n;
+    uint8_t len;
+    uint8_t i;
+
+    hal_simBusInit( &bus, 400000 );
+    hal_simDeviceInit( &dev, _JOYSTICK_I2C_ADDRESS_0, eightPath, sizeof( eightPath ) / sizeof( eightPath[ 0 ] ), 1 );
+    hal_simBusAttach( &bus, &dev );
+    hal_simGpioObj( &gpio, 0, &dev );
+
+    joystick_i2cDriverInit( (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, _JOYSTICK_I2C_ADDRESS_0 );
+    joystick_setDefaultConfiguration();
+    joystick_telemetryReset();
+
+    bytes = 0;
+    base = 0;
+
+    for ( done = 0; done < samples; done += n )
+    {
+        n = samples - done > BATCH ? BATCH : (uint8_t)( samples - done );
+
+        joystick_sampleBatch( batch, n, periodUs );
+
+        for ( i = 0; i < n; i++ )
+        {
+            batch[ i ].timestamp += base;
+            len = joystick_telemetryEncode( &batch[ i ], frame );
+            fwrite( frame, 1, len, stdout );
+            bytes += len;
+        }
+
+        base += (uint32_t)n * periodUs;
+    }
+
+    fprintf( stderr, "%ld samples, %lu bytes, %.2f bytes per sample\n", samples, bytes, (double)bytes / samples );
+    fprintf( stderr, "line rate at %lu us period : %.0f baud ( 8N1 )\n", (unsigned long)periodUs,
+             (double)bytes / samples * 10.0 * 1e6 / periodUs );
+
+    return 0;
+}
+
+static int decode( FILE *in )
+{
+    T_joystick_telemetryDecoder dec;
+    T_joystick_record record;
+    int c;
+
+    joystick_telemetryDecoderInit( &dec );
+
+    printf( "timestamp_us,x,y,button\n" );
+
+    while ( ( c = getc( in ) ) != EOF )
+    {
+        if ( joystick_telemetryDecode( &dec, (uint8_t)c, &record ) )
+            printf( "%lu,%d,%d,%u\n", (unsigned long)record.timestamp, record.x, record.y, record.button );
+    }
+
+    fprintf( stderr, "%lu frames decoded, %lu bad frames, %lu frames lost\n",
+             (unsigned long)dec.frames, (unsigned long)dec.crcErrors, (unsigned long)dec.lost );
+
+    return 0;
+}
+
+int main( int argc, char **argv )
+{
+    FILE *in;
+    int ret;
+
+    if ( argc > 1 && !strcmp( argv[ 1 ], "enc" ) )
+        return encode( argc > 2 ? atol( argv[ 2 ] ) : 1000, argc > 3 ? (uint32_t)atol( argv[ 3 ] ) : 2000 );
+
+    if ( argc > 1 && !strcmp( argv[ 1 ], "dec" ) )
+    {
+        in = stdin;
+
+        if ( argc > 2 && !( in = fopen( argv[ 2 ], "rb" ) ) )
+        {
+            perror( argv[ 2 ] );
+            return 1;
+        }
+
+        ret = decode( in );
+
+        if ( in != stdin )
+            fclose( in );
+
+        return ret;
+    }
+
+    fprintf( stderr, "usage : %s enc [samples] [periodUs] | dec [file]\n", argv[ 0 ] );
+
+    return 1;
+}
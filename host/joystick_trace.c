@@ -0,0 +1,191 @@
+/*
+Joystick Click bus trace record / replay
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build ( record ) : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -D__HAL_TRACE__ -I../library -I../library/HAL joystick_trace.c -o joystick_trace_rec
+    Build ( replay ) : cc -std=c99 -O2 -D__HAL_REPLAY__ -I../library -I../library/HAL joystick_trace.c -o joystick_trace_play
+
+---
+
+Description :
+
+The record build runs the driver on the simulation HAL wrapped by the
+capture layer and writes every bus transaction and pin access to a trace.
+The replay build feeds a trace back to the unmodified driver, so a field
+capture reproduces bit-exactly, and runs the samples through the
+calibration / filter / classifier pipeline with the selected filter.
+
+- joystick_trace_rec trace.bin [samples]            - record samples taken every 2 ms ( default 2000 )
+- joystick_trace_play trace.bin [filter] [p1] [p2]  - replay with joystick_setFilter( filter, p1, p2 ) ( default none )
+
+Both builds issue the same sequence per sample : joystick_readXY()
+followed by joystick_pressButton(), after the driver initialization and
+joystick_setDefaultConfiguration().
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "__joystick_driver.c"
+
+#ifdef __HAL_TRACE__
+
+/* Wobbly circle with a button press */
+static const T_hal_simPoint recordPath[] =
+{
+    {       0,    0,    0, 0 },
+    {  200000,   80,   10, 0 },
+    {  400000,   10,   80, 0 },
+    {  600000,  -80,  -10, 0 },
+    {  800000,  -10,  -80, 0 },
+    { 1000000,    0,    0, 1 },
+    { 1100000,    0,    0, 0 },
+    { 1500000,   22,   -3, 0 },
+    { 2000000,    0,    0, 0 }
+};
+
+int main( int argc, char **argv )
+{
+    T_hal_simBus bus;
+    T_hal_simDevice dev;
+    T_hal_gpioObj gpio;
+    int8_t ox;
+    int8_t oy;
+    long samples;
+    long i;
+
+    if ( argc < 2 )
+    {
+        fprintf( stderr, "usage : %s trace.bin [samples]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    samples = argc > 2 ? atol( argv[ 2 ] ) : 2000;
+
+    hal_simBusInit( &bus, 400000 );
+    hal_simDeviceInit( &dev, _JOYSTICK_I2C_ADDRESS_0, recordPath, sizeof( recordPath ) / sizeof( recordPath[ 0 ] ), 1 );
+    hal_simBusAttach( &bus, &dev );
+    hal_simGpioObj( &gpio, 0, &dev );
+
+    if ( hal_traceOpen( argv[ 1 ], 0 ) )
+    {
+        perror( argv[ 1 ] );
+        return 1;
+    }
+
+    joystick_i2cDriverInit( (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&bus, _JOYSTICK_I2C_ADDRESS_0 );
+    joystick_setDefaultConfiguration();
+
+    for ( i = 0; i < samples; i++ )
+    {
+        joystick_readXY( &ox, &oy );
+        joystick_pressButton();
+
+        Delay_1ms();
+        Delay_1ms();
+    }
+
+    printf( "%lu records, %ld samples, %llu us\n", (unsigned long)hal_traceClose(), samples, (unsigned long long)hal_simTimeUs );
+
+    return 0;
+}
+
+#endif
+#ifdef __HAL_REPLAY__
+
+static const char *positionName[ 9 ] =
+{
+    "Start", "Top", "Top-Right", "Right", "Bottom-Right",
+    "Bottom", "Bottom-Left", "Left", "Top-Left"
+};
+
+int main( int argc, char **argv )
+{
+    T_hal_gpioObj gpio;
+    int8_t ox;
+    int8_t oy;
+    uint8_t button;
+    uint8_t position;
+    uint8_t last;
+    long records;
+    long samples;
+    long changes;
+    uint32_t missed;
+    clock_t cpu;
+    clock_t cpuProcess;
+
+    if ( argc < 2 )
+    {
+        fprintf( stderr, "usage : %s trace.bin [filter] [p1] [p2]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    records = hal_replayOpen( argv[ 1 ] );
+
+    if ( records < 0 )
+    {
+        fprintf( stderr, "%s : not a readable trace\n", argv[ 1 ] );
+        return 1;
+    }
+
+    hal_replayGpioObj( &gpio, 0 );
+
+    joystick_i2cDriverInit( (T_JOYSTICK_P)&gpio, (T_JOYSTICK_P)&gpio, _JOYSTICK_I2C_ADDRESS_0 );
+    joystick_setDefaultConfiguration();
+    joystick_setTimeSource( hal_replayTimeUs );
+
+    if ( argc > 2 )
+        joystick_setFilter( (uint8_t)atoi( argv[ 2 ] ), argc > 3 ? (uint8_t)atoi( argv[ 3 ] ) : 0, argc > 4 ? (uint8_t)atoi( argv[ 4 ] ) : 0 );
+
+    samples = 0;
+    changes = 0;
+    last = _JOYSTICK_POSITION_START;
+    cpuProcess = 0;
+    cpu = clock();
+
+    while ( !hal_replayEnded() )
+    {
+        missed = hal_replayStats.missed;
+
+        joystick_readXY( &ox, &oy );
+        button = joystick_pressButton();
+
+        // trace ended or diverged inside this sample
+        if ( hal_replayStats.missed != missed )
+            break;
+
+        cpuProcess -= clock();
+        joystick_process( &ox, &oy );
+        position = joystick_classify( ox, oy );
+        cpuProcess += clock();
+
+        if ( position != last )
+        {
+            printf( "%10lu us  %-12s  x %4d  y %4d  button %u\n", (unsigned long)hal_replayNowUs, positionName[ position ], ox, oy, button );
+            last = position;
+            changes++;
+        }
+
+        samples++;
+    }
+
+    cpu = clock() - cpu;
+
+    printf( "\n%ld records, %ld samples, %ld direction changes\n", records, samples, changes );
+    printf( "consumed %lu, skipped %lu, unmatched calls %lu, write data mismatches %lu\n",
+            (unsigned long)hal_replayStats.consumed, (unsigned long)hal_replayStats.skipped,
+            (unsigned long)hal_replayStats.missed, (unsigned long)hal_replayStats.dataMismatches );
+    printf( "cpu : %.3f ms total, %.3f ms in process + classify\n",
+            1000.0 * cpu / CLOCKS_PER_SEC, 1000.0 * cpuProcess / CLOCKS_PER_SEC );
+
+    return hal_replayStats.missed || hal_replayStats.dataMismatches ? 2 : 0;
+}
+
+#endif
@@ -0,0 +1,224 @@
+/*
+Joystick Click direction table generator
+
+    Date          : Oct 2018.
+
+Host configuration :
+
+    OS               : Linux
+    Compiler         : gcc / clang ( C99 )
+    Build            : cc -std=c99 -O2 -D__HAL_HOST_SIM__ -I../library -I../library/HAL joystick_zonegen.c -o joystick_zonegen
+
+---
+
+Description :
+
+Generates _JOYSTICK_ZONE_TABLE of __joystick_driver.c from the reference
+direction rule and checks the driver classifier against the reference
+for all 65,536 ( x, y ) pairs. The reference rule itself is checked with
+the default thresholds against fixed cases written from the position
+codes of joystick_getPosition() : negative X is right, positive Y is top.
+
+- joystick_zonegen                  - print table, check default thresholds ( 20, 60 )
+- joystick_zonegen <low> <high>     - print table, check default and given thresholds
+
+Exit status is non-zero when the driver and the reference disagree.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "__joystick_driver.c"
+
+/* Reference rule written with plain comparisons, the table is derived from it */
+static uint8_t referenceClassify( int ox, int oy, int lo, int hi )
+{
+    int ax;
+    int ay;
+    int right;
+    int top;
+    int useX;
+    int useY;
+
+    ax = ox < 0 ? -ox : ox;
+    ay = oy < 0 ? -oy : oy;
+    right = ox < 0;
+    top = oy > 0;
+
+    useX = ax >= lo;
+    useY = ay >= lo;
+
+    // strong axis dominates a weak one
+    if ( useX && useY )
+    {
+        if ( ax >= hi && ay < hi )
+            useY = 0;
+        else if ( ay >= hi && ax < hi )
+            useX = 0;
+    }
+
+    if ( !useX && !useY )
+        return 0;
+    if ( !useX )
+        return top ? 1 : 5;
+    if ( !useY )
+        return right ? 3 : 7;
+    if ( top )
+        return right ? 2 : 8;
+
+    return right ? 4 : 6;
+}
+
+/* Fixed cases for thresholds ( 20, 60 ), independent of the reference rule */
+static const int fixedCases[][ 3 ] =
+{
+    // x, y, position
+    {    0,    0, 0 },      // start
+    {   19,  -19, 0 },      // inside the low threshold
+    {    0,   60, 1 },      // top
+    {    0,  127, 1 },
+    {  -60,    0, 3 },      // right
+    { -128,    0, 3 },
+    {    0,  -60, 5 },      // bottom
+    {    0, -128, 5 },
+    {   60,    0, 7 },      // left
+    {  127,    0, 7 },
+    {  -40,   40, 2 },      // top-right
+    {  -40,  -40, 4 },      // bottom-right
+    {   40,  -40, 6 },      // bottom-left
+    {   40,   40, 8 },      // top-left
+    {  -70,   70, 2 },      // both axes strong stay diagonal
+    { -128, -128, 4 },
+    {  127, -128, 6 },
+    {  127,  127, 8 },
+
+    // results changed from the former cascade
+    {   40,    0, 7 },      // weak X only, was top-left
+    {  -40,    0, 3 },      // weak X only, was bottom-right
+    {   20,    0, 7 },      // low threshold reached
+    {  -20,    0, 3 },
+    {    0,   40, 1 },      // weak Y only, was start
+    {    0,   20, 1 },
+    {    0,  -20, 5 },
+    {   20,   70, 1 },      // strong Y dominates weak X, was start
+    {  -30,  -70, 5 },
+    {   70,   30, 7 },      // strong X dominates weak Y
+    {  -70,  -30, 3 },
+    {   59,  -59, 6 },      // both weak stay diagonal
+    {   60,  -59, 7 }
+};
+
+/* Representative value of every zone for thresholds ( lo, hi ) */
+static int zoneValue( int zone, int lo, int hi )
+{
+    switch ( zone )
+    {
+        case 0 : return -hi;
+        case 1 : return -lo;
+        case 2 : return 0;
+        case 3 : return lo;
+        default : return hi;
+    }
+}
+
+static unsigned long checkFixedCases( T_hal_simBus *bus, T_hal_gpioObj *gpio )
+{
+    T_joystick_ctx ctx;
+    unsigned long errors;
+    uint8_t got;
+    uint8_t i;
+    uint8_t n;
+
+    joystick_ctxI2cDriverInit( &ctx, (T_JOYSTICK_P)gpio, (T_JOYSTICK_P)bus, 0x40 );
+    joystick_ctxSetThresholds( &ctx, 20, 60 );
+
+    errors = 0;
+    n = sizeof( fixedCases ) / sizeof( fixedCases[ 0 ] );
+
+    for ( i = 0; i < n; i++ )
+    {
+        got = joystick_ctxClassify( &ctx, fixedCases[ i ][ 0 ], fixedCases[ i ][ 1 ] );
+
+        if ( got != fixedCases[ i ][ 2 ] || referenceClassify( fixedCases[ i ][ 0 ], fixedCases[ i ][ 1 ], 20, 60 ) != fixedCases[ i ][ 2 ] )
+        {
+            fprintf( stderr, "fixed case x=%d y=%d : %u != %d\n", fixedCases[ i ][ 0 ], fixedCases[ i ][ 1 ], got, fixedCases[ i ][ 2 ] );
+            errors++;
+        }
+    }
+
+    printf( "/* fixed cases : %u pairs, %lu mismatches */\n", n, errors );
+
+    return errors;
+}
+
+static unsigned long sweep( T_hal_simBus *bus, T_hal_gpioObj *gpio, int lo, int hi )
+{
+    T_joystick_ctx ctx;
+    unsigned long errors;
+    int x;
+    int y;
+
+    joystick_ctxI2cDriverInit( &ctx, (T_JOYSTICK_P)gpio, (T_JOYSTICK_P)bus, 0x40 );
+    joystick_ctxSetThresholds( &ctx, lo, hi );
+
+    errors = 0;
+
+    for ( y = -128; y <= 127; y++ )
+    {
+        for ( x = -128; x <= 127; x++ )
+        {
+            uint8_t got = joystick_ctxClassify( &ctx, x, y );
+            uint8_t exp = referenceClassify( x, y, ctx.lowThreshold, ctx.highThreshold );
+
+            if ( got != exp )
+            {
+                if ( errors < 10 )
+                    fprintf( stderr, "mismatch lo=%d hi=%d x=%d y=%d : %u != %u\n",
+                             ctx.lowThreshold, ctx.highThreshold, x, y, got, exp );
+                errors++;
+            }
+        }
+    }
+
+    printf( "/* thresholds ( %d, %d ) : 65536 pairs, %lu mismatches */\n",
+            ctx.lowThreshold, ctx.highThreshold, errors );
+
+    return errors;
+}
+
+int main( int argc, char **argv )
+{
+    T_hal_simDevice dev;
+    T_hal_simBus bus;
+    T_hal_gpioObj gpio;
+    unsigned long errors;
+    int zx;
+    int zy;
+
+    hal_simBusInit( &bus, 400000 );
+    hal_simDeviceInit( &dev, 0x40, 0, 0, 0 );
+    hal_simBusAttach( &bus, &dev );
+    hal_simGpioObj( &gpio, 0, &dev );
+
+    printf( "const uint8_t _JOYSTICK_ZONE_TABLE[ 5 ][ 5 ] =\n{\n" );
+
+    for ( zy = 0; zy < 5; zy++ )
+    {
+        printf( "    {" );
+        for ( zx = 0; zx < 5; zx++ )
+            printf( " %u%s", referenceClassify( zoneValue( zx, 20, 60 ), zoneValue( zy, 20, 60 ), 20, 60 ),
+                    zx < 4 ? "," : "" );
+        printf( " }%s\n", zy < 4 ? "," : "" );
+    }
+
+    printf( "};\n\n" );
+
+    errors = checkFixedCases( &bus, &gpio );
+    errors += sweep( &bus, &gpio, 20, 60 );
+
+    if ( argc == 3 )
+        errors += sweep( &bus, &gpio, atoi( argv[ 1 ] ), atoi( argv[ 2 ] ) );
+
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
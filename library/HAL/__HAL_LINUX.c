@@ -0,0 +1,452 @@
+/*
+    __HAL_LINUX.c
+
+-----------------------------------------------------------------------------
+
+  This file is part of mikroSDK.
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+----------------------------------------------------------------------------- */
+
+/**
+@file   __HAL_LINUX.c
+@brief  Linux i2c-dev HAL
+*/
+/**
+@defgroup   JOYSTICK_HAL_LINUX
+@brief      Linux i2c-dev HAL
+@{
+
+Selected in __joystick_hal.c by defining __HAL_LINUX__. The I2C object
+passed to the driver is a T_hal_linuxBus opened by hal_linuxBusOpen() on
+/dev/i2c-N, the GPIO object is filled by hal_linuxGpioObj().
+
+Every transfer goes through the I2C_RDWR ioctl. Messages are queued from
+hal_i2cStart() and sent as one combined transaction when a write or read
+ends with END_MODE_STOP, so the register address write and the data read
+of joystick_readData() are one syscall with a repeated START between them,
+and a register write is one syscall as well, without the I2C_SLAVE ioctl
+plain read() / write() would need.
+
+The INT pin can be requested as a GPIO line event fd with
+hal_linuxIntOpen(), so an application can sleep in poll / epoll until the
+AS5013 signals a new measurement instead of polling the bus. The button
+( CS ) pin reads a line requested with hal_linuxButtonOpen().
+
+A write or read ending with END_MODE_RESTART only queues its message and
+returns 0, errors of the whole transaction are returned by the call ending
+it. Read data is stored at that point, the buffers of queued reads must
+stay valid until then, as they do in the driver. A failed transaction
+counts in T_hal_linuxBus.errors and fills its read buffers with zeros;
+the driver reports it through joystick_getI2cError().
+
+The ioctl goes through T_hal_linuxBus.ioctlFp, which hal_linuxBusOpen()
+sets to the system call; a stand-in can be plugged in to run without
+hardware. Programs including the driver with this HAL define
+_POSIX_C_SOURCE 200809L before any header.
+
+With __HAL_THREADS__ the mapped bus and the INT line are per thread, so
+one thread per adapter can run the driver at the same time
+( host/joystick_engine.h ).
+*/
+/* -------------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/gpio.h>
+
+#define END_MODE_RESTART            0
+#define END_MODE_STOP               1
+
+#define _HAL_LINUX_MAX_MSGS         4
+#define _HAL_LINUX_WRITE_MAX        32
+
+/** ioctl( fd, request, arg ) */
+typedef int (*T_hal_linuxIoctlFp)( int, unsigned long, void* );
+
+/** i2c-dev adapter with the transaction being queued and syscall counters */
+typedef struct
+{
+    int                     fd;
+    T_hal_linuxIoctlFp      ioctlFp;
+
+    struct i2c_msg          msgs[ _HAL_LINUX_MAX_MSGS ];
+    uint8_t                 nMsgs;
+    uint8_t                 wBuf[ _HAL_LINUX_WRITE_MAX ];
+    uint8_t                 wLen;
+
+    uint32_t                ioctls;
+    uint32_t                errors;
+
+}T_hal_linuxBus;
+
+static HAL_TLS T_hal_linuxBus *hal_linuxBus;
+
+/* -------------------------------------------------------------------- CLOCK */
+
+/** Monotonic time in microseconds */
+static inline uint64_t hal_linuxTimeUs()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/** Sleep for us microseconds, signals resume the remaining time, other errors end the delay */
+static void hal_linuxSleepUs( uint32_t us )
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000u;
+    ts.tv_nsec = ( us % 1000000u ) * 1000;
+
+    while ( nanosleep( &ts, &ts ) && errno == EINTR )
+        ;
+}
+
+/* Compiler built-in delays of the mikroC targets */
+void Delay_10us()  { hal_linuxSleepUs( 10 ); }
+void Delay_1ms()   { hal_linuxSleepUs( 1000 ); }
+void Delay_10ms()  { hal_linuxSleepUs( 10000 ); }
+void Delay_100ms() { hal_linuxSleepUs( 100000 ); }
+
+/* ---------------------------------------------------------------------- BUS */
+
+static int hal_linuxIoctl( int fd, unsigned long request, void *arg )
+{
+    return ioctl( fd, request, arg );
+}
+
+/**
+ * Open adapter at path ( e.g. "/dev/i2c-1" ), or only set up the bus when
+ * path is 0 and ioctlFp is a stand-in. ioctlFp 0 selects the system call.
+ * Returns 0 on success.
+ */
+static inline int hal_linuxBusOpen( T_hal_linuxBus *bus, const char *path, T_hal_linuxIoctlFp ioctlFp )
+{
+    memset( bus, 0, sizeof( *bus ) );
+
+    bus->fd = -1;
+    bus->ioctlFp = ioctlFp ? ioctlFp : hal_linuxIoctl;
+
+    if ( !path )
+        return 0;
+
+    bus->fd = open( path, O_RDWR );
+
+    return bus->fd < 0;
+}
+
+static inline void hal_linuxBusClose( T_hal_linuxBus *bus )
+{
+    if ( bus->fd >= 0 )
+        close( bus->fd );
+
+    bus->fd = -1;
+}
+
+/* Queue one message, a full queue or write buffer fails the transaction */
+static int hal_linuxQueue( uint8_t slaveAddress, uint16_t flags, uint8_t *pBuf, uint16_t nBytes )
+{
+    struct i2c_msg *msg;
+
+    if ( hal_linuxBus->nMsgs == _HAL_LINUX_MAX_MSGS )
+        return 1;
+
+    msg = &hal_linuxBus->msgs[ hal_linuxBus->nMsgs++ ];
+    msg->addr = slaveAddress;
+    msg->flags = flags;
+    msg->len = nBytes;
+    msg->buf = pBuf;
+
+    return 0;
+}
+
+/* Drop the queued transaction, reads of a failed one return zeros rather than stale memory */
+static void hal_linuxAbort()
+{
+    uint8_t i;
+
+    for ( i = 0; i < hal_linuxBus->nMsgs; i++ )
+    {
+        if ( hal_linuxBus->msgs[ i ].flags & I2C_M_RD )
+            memset( hal_linuxBus->msgs[ i ].buf, 0, hal_linuxBus->msgs[ i ].len );
+    }
+
+    hal_linuxBus->errors++;
+    hal_linuxBus->nMsgs = 0;
+    hal_linuxBus->wLen = 0;
+}
+
+/* Send the queued messages as one combined transaction */
+static int hal_linuxFlush()
+{
+    struct i2c_rdwr_ioctl_data rdwr;
+    int ret;
+
+    rdwr.msgs = hal_linuxBus->msgs;
+    rdwr.nmsgs = hal_linuxBus->nMsgs;
+
+    hal_linuxBus->ioctls++;
+    ret = hal_linuxBus->ioctlFp( hal_linuxBus->fd, I2C_RDWR, &rdwr ) < 0;
+
+    if ( ret )
+    {
+        hal_linuxAbort();
+        return ret;
+    }
+
+    hal_linuxBus->nMsgs = 0;
+    hal_linuxBus->wLen = 0;
+
+    return ret;
+}
+
+/* ---------------------------------------------------------------------- I2C */
+
+static void hal_i2cMap(T_HAL_P i2cObj)
+{
+    hal_linuxBus = (T_hal_linuxBus*)i2cObj;
+}
+
+static int hal_i2cStart(void)
+{
+    hal_linuxBus->nMsgs = 0;
+    hal_linuxBus->wLen = 0;
+
+    return 0;
+}
+
+static int hal_i2cWrite(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    uint8_t *copy;
+
+    // the caller may reuse its buffer before the transaction is sent
+    if ( hal_linuxBus->wLen + nBytes > _HAL_LINUX_WRITE_MAX )
+    {
+        hal_linuxAbort();
+        return 1;
+    }
+
+    copy = &hal_linuxBus->wBuf[ hal_linuxBus->wLen ];
+    memcpy( copy, pBuf, nBytes );
+    hal_linuxBus->wLen += nBytes;
+
+    if ( hal_linuxQueue( slaveAddress, 0, copy, nBytes ) )
+    {
+        hal_linuxAbort();
+        return 1;
+    }
+
+    return endMode == END_MODE_STOP ? hal_linuxFlush() : 0;
+}
+
+static int hal_i2cRead(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    if ( hal_linuxQueue( slaveAddress, I2C_M_RD, pBuf, nBytes ) )
+    {
+        memset( pBuf, 0, nBytes );
+        hal_linuxAbort();
+        return 1;
+    }
+
+    return endMode == END_MODE_STOP ? hal_linuxFlush() : 0;
+}
+
+/* --------------------------------------------------------------------- GPIO */
+
+/* Line event fd of the INT pin, -1 when not requested */
+static HAL_TLS int          hal_linuxIntFd = -1;
+
+/* Line handle fd of the button ( CS ) pin, -1 when not requested */
+static HAL_TLS int          hal_linuxButtonFd = -1;
+
+static uint8_t hal_linuxPinLow() { return 0; }
+static void hal_linuxPinNone( uint8_t state ) { (void)state; }
+
+/* INT level, high ( no data ready ) without a requested line */
+static uint8_t hal_linuxIntGet()
+{
+    struct gpiohandle_data data;
+
+    if ( hal_linuxIntFd < 0 || ioctl( hal_linuxIntFd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data ) < 0 )
+        return 1;
+
+    return data.values[ 0 ];
+}
+
+/* Button level, released without a requested line */
+static uint8_t hal_linuxButtonGet()
+{
+    struct gpiohandle_data data;
+
+    if ( hal_linuxButtonFd < 0 || ioctl( hal_linuxButtonFd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data ) < 0 )
+        return 0;
+
+    return data.values[ 0 ];
+}
+
+/**
+ * Request falling edge events of the INT pin on line of the GPIO chip at
+ * path ( e.g. "/dev/gpiochip0" ). The returned fd becomes readable on every
+ * edge, for poll / epoll, and backs the INT pin of hal_linuxGpioObj().
+ * Returns -1 on failure.
+ */
+static inline int hal_linuxIntOpen( const char *path, uint32_t line )
+{
+    struct gpioevent_request req;
+    int chip;
+
+    chip = open( path, O_RDONLY );
+
+    if ( chip < 0 )
+        return -1;
+
+    memset( &req, 0, sizeof( req ) );
+    req.lineoffset = line;
+    req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+    strcpy( req.consumer_label, "joystick-int" );
+
+    if ( ioctl( chip, GPIO_GET_LINEEVENT_IOCTL, &req ) < 0 )
+        req.fd = -1;
+
+    close( chip );
+
+    if ( req.fd >= 0 )
+        fcntl( req.fd, F_SETFL, O_NONBLOCK );
+
+    hal_linuxIntFd = req.fd;
+
+    return req.fd;
+}
+
+/** Consume the queued edge events of the INT line, returns their number */
+static inline uint32_t hal_linuxIntAck( int fd )
+{
+    struct gpioevent_data event;
+    uint32_t n;
+
+    n = 0;
+
+    while ( read( fd, &event, sizeof( event ) ) == (ssize_t)sizeof( event ) )
+        n++;
+
+    return n;
+}
+
+static inline void hal_linuxIntClose()
+{
+    if ( hal_linuxIntFd >= 0 )
+        close( hal_linuxIntFd );
+
+    hal_linuxIntFd = -1;
+}
+
+/**
+ * Request line of the GPIO chip at path as input for the button ( CS ) pin
+ * of hal_linuxGpioObj(). Returns the line handle fd, -1 on failure.
+ */
+static inline int hal_linuxButtonOpen( const char *path, uint32_t line )
+{
+    struct gpiohandle_request req;
+    int chip;
+
+    chip = open( path, O_RDONLY );
+
+    if ( chip < 0 )
+        return -1;
+
+    memset( &req, 0, sizeof( req ) );
+    req.lineoffsets[ 0 ] = line;
+    req.lines = 1;
+    req.flags = GPIOHANDLE_REQUEST_INPUT;
+    strcpy( req.consumer_label, "joystick-button" );
+
+    if ( ioctl( chip, GPIO_GET_LINEHANDLE_IOCTL, &req ) < 0 )
+        req.fd = -1;
+
+    close( chip );
+
+    hal_linuxButtonFd = req.fd;
+
+    return req.fd;
+}
+
+static inline void hal_linuxButtonClose()
+{
+    if ( hal_linuxButtonFd >= 0 )
+        close( hal_linuxButtonFd );
+
+    hal_linuxButtonFd = -1;
+}
+
+/**
+ * Fill GPIO object : INT from the line requested by hal_linuxIntOpen(),
+ * button from the line requested by hal_linuxButtonOpen() ( released
+ * without one ), RST ignored. Entries can be replaced by the application.
+ */
+static inline void hal_linuxGpioObj( T_hal_gpioObj *gpio )
+{
+    uint8_t i;
+
+    for ( i = 0; i < 12; i++ )
+    {
+        gpio->gpioGet[ i ] = hal_linuxPinLow;
+        gpio->gpioSet[ i ] = hal_linuxPinNone;
+    }
+
+    gpio->gpioGet[ 2 ] = hal_linuxButtonGet;
+    gpio->gpioGet[ 7 ] = hal_linuxIntGet;
+}
+                                                                       /** @} */
+/* -------------------------------------------------------------------------- */
+/*
+  __HAL_LINUX.c
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+3. All advertising materials mentioning features or use of this software
+   must display the following acknowledgement:
+   This product includes software developed by the MikroElektonika.
+
+4. Neither the name of the MikroElektonika nor the
+   names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY MIKROELEKTRONIKA ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL MIKROELEKTRONIKA BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------------- */
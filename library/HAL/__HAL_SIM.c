@@ -0,0 +1,504 @@
+/*
+    __HAL_SIM.c
+
+-----------------------------------------------------------------------------
+
+  This file is part of mikroSDK.
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+----------------------------------------------------------------------------- */
+
+/**
+@file   __HAL_SIM.c
+@brief  Host HAL backed by an AS5013 register model
+*/
+/**
+@defgroup   JOYSTICK_HAL_SIM
+@brief      Host Simulation HAL
+@{
+
+Selected in __joystick_hal.c by defining __HAL_HOST_SIM__ when the driver
+is compiled with gcc / clang on a PC. The I2C object passed to the driver
+is a T_hal_simBus holding up to _HAL_SIM_MAX_DEVICES register models,
+the GPIO object is filled by hal_simGpioObj().
+
+Model of the AS5013 Hall IC :
+
+- register file with auto-incrementing register pointer,
+- X / Y_res_int follow a scripted trajectory, linear between points,
+  X is sampled when register 0x10 is read, Y_res_int returns the Y
+  captured together with it and releases INT,
+- INT ( active low ) is asserted while a sample differing from the
+  last one read is available and Control 1 bit 2 is set,
+- XP / XN / YP / YN return the positive / negative part of X / Y,
+- writing Soft_rst to Control 1 reloads the reset values of the
+  writable registers, Control 1 included, and RST pin low resets the
+  whole register file.
+
+Time is virtual : every I2C byte costs 9 SCL periods, START costs one,
+Delay_* calls advance the clock by their nominal time.
+With __HAL_THREADS__ the clock, the mapped bus and the pin slots are per
+thread, every thread then runs its buses on its own virtual clock.
+*/
+/* -------------------------------------------------------------------------- */
+
+#include <stdint.h>
+
+#define END_MODE_RESTART            0
+#define END_MODE_STOP               1
+
+#define _HAL_SIM_MAX_DEVICES        4
+#define _HAL_SIM_REG_COUNT          0x30
+
+/** Trajectory point, the stick is at ( x, y ) at time timeUs */
+typedef struct
+{
+    uint32_t            timeUs;
+    int8_t              x;
+    int8_t              y;
+    uint8_t             button;
+
+}T_hal_simPoint;
+
+/** AS5013 register model */
+typedef struct
+{
+    uint8_t                 address;
+    uint8_t                 regs[ _HAL_SIM_REG_COUNT ];
+    uint8_t                 pointer;
+    uint8_t                 rstLevel;
+    int8_t                  lastX;
+    int8_t                  lastY;
+
+    const T_hal_simPoint   *path;
+    uint16_t                pathLen;
+    uint8_t                 pathLoop;
+
+}T_hal_simDevice;
+
+/** I2C bus with attached register models and bus cost counters */
+typedef struct
+{
+    T_hal_simDevice    *dev[ _HAL_SIM_MAX_DEVICES ];
+    uint8_t             nDev;
+    uint32_t            clockHz;
+
+    uint32_t            starts;
+    uint32_t            bytes;
+    uint32_t            nacks;
+
+}T_hal_simBus;
+
+/* Virtual time in microseconds, shared by all buses ( per thread with __HAL_THREADS__ ) */
+static HAL_TLS uint64_t         hal_simTimeUs;
+static HAL_TLS uint32_t         hal_simTimeFracNs;
+
+static HAL_TLS T_hal_simBus    *hal_simBus;
+
+/* -------------------------------------------------------------------- CLOCK */
+
+static void hal_simAdvanceNs( uint32_t ns )
+{
+    hal_simTimeFracNs += ns;
+    hal_simTimeUs += hal_simTimeFracNs / 1000;
+    hal_simTimeFracNs %= 1000;
+}
+
+static void hal_simBusCycles( uint32_t cycles )
+{
+    if ( hal_simBus && hal_simBus->clockHz )
+        hal_simAdvanceNs( (uint32_t)( ( 1000000000ULL * cycles ) / hal_simBus->clockHz ) );
+}
+
+/* Compiler built-in delays of the mikroC targets */
+void Delay_10us()  { hal_simAdvanceNs( 10000 ); }
+void Delay_1ms()   { hal_simTimeUs += 1000; }
+void Delay_10ms()  { hal_simTimeUs += 10000; }
+void Delay_100ms() { hal_simTimeUs += 100000; }
+
+/* -------------------------------------------------------------------- MODEL */
+
+/** ID and measurement registers, written by the chip only */
+static uint8_t hal_simRegReadOnly( uint8_t reg )
+{
+    return ( reg >= 0x0C && reg <= 0x0E ) || ( reg >= 0x10 && reg <= 0x15 );
+}
+
+/** Load reset values into the writable registers ( Soft_rst ) */
+static void hal_simDeviceSoftReset( T_hal_simDevice *dev )
+{
+    uint8_t i;
+
+    for ( i = 0; i < _HAL_SIM_REG_COUNT; i++ )
+        if ( !hal_simRegReadOnly( i ) )
+            dev->regs[ i ] = 0;
+
+    dev->regs[ 0x0F ] = 0xF0 & 0x7F;        // control 1, Soft_rst already cleared
+    dev->regs[ 0x2D ] = 0x09;               // T_ctrl, 100 %
+}
+
+/** Load reset values into the register file */
+static void hal_simDeviceReset( T_hal_simDevice *dev )
+{
+    uint8_t i;
+
+    for ( i = 0; i < _HAL_SIM_REG_COUNT; i++ )
+        dev->regs[ i ] = 0;
+
+    dev->regs[ 0x0C ] = 0x0C;               // ID code
+    dev->regs[ 0x0D ] = 0x0D;               // ID version
+    dev->regs[ 0x0E ] = 0x01;               // silicon revision
+    hal_simDeviceSoftReset( dev );
+    dev->pointer = 0;
+    dev->lastX = 0;
+    dev->lastY = 0;
+}
+
+/** Initialize register model at 7-bit address with trajectory ( path may be 0 ) */
+static inline void hal_simDeviceInit( T_hal_simDevice *dev, uint8_t address,
+                               const T_hal_simPoint *path, uint16_t pathLen, uint8_t loop )
+{
+    dev->address = address;
+    dev->path = path;
+    dev->pathLen = pathLen;
+    dev->pathLoop = loop;
+    dev->rstLevel = 1;
+
+    hal_simDeviceReset( dev );
+}
+
+/** Initialize empty bus clocked at clockHz */
+static inline void hal_simBusInit( T_hal_simBus *bus, uint32_t clockHz )
+{
+    bus->nDev = 0;
+    bus->clockHz = clockHz;
+    bus->starts = 0;
+    bus->bytes = 0;
+    bus->nacks = 0;
+}
+
+/** Attach register model to bus */
+static inline void hal_simBusAttach( T_hal_simBus *bus, T_hal_simDevice *dev )
+{
+    if ( bus->nDev < _HAL_SIM_MAX_DEVICES )
+        bus->dev[ bus->nDev++ ] = dev;
+}
+
+/** Stick state of the trajectory at current virtual time */
+static void hal_simDeviceStick( T_hal_simDevice *dev, int8_t *x, int8_t *y, uint8_t *button )
+{
+    const T_hal_simPoint *a;
+    const T_hal_simPoint *b;
+    uint64_t t;
+    uint32_t span;
+    uint32_t dt;
+    uint16_t i;
+
+    *x = 0;
+    *y = 0;
+    *button = 0;
+
+    if ( !dev->path || !dev->pathLen )
+        return;
+
+    t = hal_simTimeUs;
+
+    if ( dev->pathLoop && dev->path[ dev->pathLen - 1 ].timeUs )
+        t %= dev->path[ dev->pathLen - 1 ].timeUs;
+
+    for ( i = 1; i < dev->pathLen && dev->path[ i ].timeUs <= t; i++ );
+
+    a = &dev->path[ i - 1 ];
+    *button = a->button;
+
+    if ( i == dev->pathLen || t <= a->timeUs )
+    {
+        *x = a->x;
+        *y = a->y;
+        return;
+    }
+
+    b = &dev->path[ i ];
+    span = b->timeUs - a->timeUs;
+    dt = (uint32_t)( t - a->timeUs );
+
+    *x = (int8_t)( a->x + ( (int32_t)( b->x - a->x ) * (int32_t)dt ) / (int32_t)span );
+    *y = (int8_t)( a->y + ( (int32_t)( b->y - a->y ) * (int32_t)dt ) / (int32_t)span );
+}
+
+static uint8_t hal_simRegRead( T_hal_simDevice *dev )
+{
+    uint8_t reg;
+    uint8_t value;
+    int8_t x;
+    int8_t y;
+    uint8_t button;
+
+    reg = dev->pointer++;
+
+    if ( reg >= _HAL_SIM_REG_COUNT )
+        return 0;
+
+    switch ( reg )
+    {
+        case 0x10 :
+            hal_simDeviceStick( dev, &x, &y, &button );
+            dev->regs[ 0x10 ] = (uint8_t)x;
+            dev->regs[ 0x11 ] = (uint8_t)y;
+            dev->regs[ 0x12 ] = x > 0 ? x : 0;
+            dev->regs[ 0x13 ] = x < 0 ? -x : 0;
+            dev->regs[ 0x14 ] = y > 0 ? y : 0;
+            dev->regs[ 0x15 ] = y < 0 ? -y : 0;
+            dev->lastX = x;
+            value = dev->regs[ reg ];
+            break;
+        case 0x11 :
+            dev->lastY = (int8_t)dev->regs[ 0x11 ];
+            value = dev->regs[ reg ];
+            break;
+        default :
+            value = dev->regs[ reg ];
+            break;
+    }
+
+    return value;
+}
+
+static void hal_simRegWrite( T_hal_simDevice *dev, uint8_t value )
+{
+    uint8_t reg;
+
+    reg = dev->pointer++;
+
+    if ( reg >= _HAL_SIM_REG_COUNT || hal_simRegReadOnly( reg ) )
+        return;
+
+    // the reset sequence ends before the next transfer
+    if ( reg == 0x0F && ( value & 0x80 ) )
+    {
+        hal_simDeviceSoftReset( dev );
+        return;
+    }
+
+    dev->regs[ reg ] = value;
+}
+
+static T_hal_simDevice *hal_simFind( uint8_t slaveAddress )
+{
+    uint8_t i;
+
+    if ( !hal_simBus )
+        return 0;
+
+    for ( i = 0; i < hal_simBus->nDev; i++ )
+        if ( hal_simBus->dev[ i ]->address == slaveAddress && hal_simBus->dev[ i ]->rstLevel )
+            return hal_simBus->dev[ i ];
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- I2C */
+
+static void hal_i2cMap(T_HAL_P i2cObj)
+{
+    hal_simBus = (T_hal_simBus*)i2cObj;
+}
+
+static int hal_i2cStart(void)
+{
+    if ( hal_simBus )
+        hal_simBus->starts++;
+
+    hal_simBusCycles( 1 );
+
+    return 0;
+}
+
+static int hal_i2cWrite(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    T_hal_simDevice *dev;
+    uint16_t i;
+
+    (void)endMode;
+
+    dev = hal_simFind( slaveAddress );
+    hal_simBusCycles( 9 * ( 1 + nBytes ) + 1 );
+
+    if ( !dev )
+    {
+        if ( hal_simBus )
+            hal_simBus->nacks++;
+        return 1;
+    }
+
+    hal_simBus->bytes += 1 + nBytes;
+
+    if ( nBytes )
+        dev->pointer = pBuf[ 0 ];
+
+    for ( i = 1; i < nBytes; i++ )
+        hal_simRegWrite( dev, pBuf[ i ] );
+
+    return 0;
+}
+
+static int hal_i2cRead(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    T_hal_simDevice *dev;
+    uint16_t i;
+
+    (void)endMode;
+
+    dev = hal_simFind( slaveAddress );
+    hal_simBusCycles( 9 * ( 1 + nBytes ) + 1 );
+
+    if ( !dev )
+    {
+        if ( hal_simBus )
+            hal_simBus->nacks++;
+        return 1;
+    }
+
+    hal_simBus->bytes += 1 + nBytes;
+
+    for ( i = 0; i < nBytes; i++ )
+        pBuf[ i ] = hal_simRegRead( dev );
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------- GPIO */
+
+/* GPIO function pointers take no argument, so pins are bound to fixed slots */
+static HAL_TLS T_hal_simDevice *hal_simSlot[ _HAL_SIM_MAX_DEVICES ];
+
+static uint8_t hal_simIntLevel( T_hal_simDevice *dev )
+{
+    int8_t x;
+    int8_t y;
+    uint8_t button;
+
+    if ( !dev || !( dev->regs[ 0x0F ] & 0x04 ) )
+        return 1;
+
+    hal_simDeviceStick( dev, &x, &y, &button );
+
+    return ( x != dev->lastX || y != dev->lastY ) ? 0 : 1;
+}
+
+static uint8_t hal_simButtonLevel( T_hal_simDevice *dev )
+{
+    int8_t x;
+    int8_t y;
+    uint8_t button;
+
+    if ( !dev )
+        return 0;
+
+    hal_simDeviceStick( dev, &x, &y, &button );
+
+    return button;
+}
+
+static void hal_simRstLevel( T_hal_simDevice *dev, uint8_t state )
+{
+    if ( !dev )
+        return;
+
+    if ( !dev->rstLevel && state )
+        hal_simDeviceReset( dev );
+
+    dev->rstLevel = state;
+}
+
+static uint8_t hal_simIntGet0() { return hal_simIntLevel( hal_simSlot[ 0 ] ); }
+static uint8_t hal_simIntGet1() { return hal_simIntLevel( hal_simSlot[ 1 ] ); }
+static uint8_t hal_simIntGet2() { return hal_simIntLevel( hal_simSlot[ 2 ] ); }
+static uint8_t hal_simIntGet3() { return hal_simIntLevel( hal_simSlot[ 3 ] ); }
+static uint8_t hal_simCsGet0() { return hal_simButtonLevel( hal_simSlot[ 0 ] ); }
+static uint8_t hal_simCsGet1() { return hal_simButtonLevel( hal_simSlot[ 1 ] ); }
+static uint8_t hal_simCsGet2() { return hal_simButtonLevel( hal_simSlot[ 2 ] ); }
+static uint8_t hal_simCsGet3() { return hal_simButtonLevel( hal_simSlot[ 3 ] ); }
+static void hal_simRstSet0( uint8_t state ) { hal_simRstLevel( hal_simSlot[ 0 ], state ); }
+static void hal_simRstSet1( uint8_t state ) { hal_simRstLevel( hal_simSlot[ 1 ], state ); }
+static void hal_simRstSet2( uint8_t state ) { hal_simRstLevel( hal_simSlot[ 2 ], state ); }
+static void hal_simRstSet3( uint8_t state ) { hal_simRstLevel( hal_simSlot[ 3 ], state ); }
+
+/* One pin set per slot, as many slots as devices on a bus */
+#if _HAL_SIM_MAX_DEVICES != 4
+#error "hal_simSlot pins are written out for 4 devices"
+#endif
+
+static const T_hal_gpioGetFp hal_simIntGet[ _HAL_SIM_MAX_DEVICES ] = { hal_simIntGet0, hal_simIntGet1, hal_simIntGet2, hal_simIntGet3 };
+static const T_hal_gpioGetFp hal_simCsGet[ _HAL_SIM_MAX_DEVICES ] = { hal_simCsGet0, hal_simCsGet1, hal_simCsGet2, hal_simCsGet3 };
+static const T_hal_gpioSetFp hal_simRstSet[ _HAL_SIM_MAX_DEVICES ] = { hal_simRstSet0, hal_simRstSet1, hal_simRstSet2, hal_simRstSet3 };
+static uint8_t hal_simPinLow() { return 0; }
+static void hal_simPinNone( uint8_t state ) { (void)state; }
+
+/**
+ * Fill GPIO object with the pins of register model in slot, below
+ * _HAL_SIM_MAX_DEVICES. Returns 1 and leaves gpio unchanged for a slot out of range.
+ */
+static inline uint8_t hal_simGpioObj( T_hal_gpioObj *gpio, uint8_t slot, T_hal_simDevice *dev )
+{
+    uint8_t i;
+
+    if ( slot >= _HAL_SIM_MAX_DEVICES )
+        return 1;
+
+    hal_simSlot[ slot ] = dev;
+
+    for ( i = 0; i < 12; i++ )
+    {
+        gpio->gpioGet[ i ] = hal_simPinLow;
+        gpio->gpioSet[ i ] = hal_simPinNone;
+    }
+
+    gpio->gpioGet[ 2 ] = hal_simCsGet[ slot ];
+    gpio->gpioGet[ 7 ] = hal_simIntGet[ slot ];
+    gpio->gpioSet[ 1 ] = hal_simRstSet[ slot ];
+
+    return 0;
+}
+                                                                       /** @} */
+/* -------------------------------------------------------------------------- */
+/*
+  __HAL_SIM.c
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+3. All advertising materials mentioning features or use of this software
+   must display the following acknowledgement:
+   This product includes software developed by the MikroElektonika.
+
+4. Neither the name of the MikroElektonika nor the
+   names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY MIKROELEKTRONIKA ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL MIKROELEKTRONIKA BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------------- */
@@ -0,0 +1,539 @@
+/*
+    __HAL_TRACE.c
+
+-----------------------------------------------------------------------------
+
+  This file is part of mikroSDK.
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+----------------------------------------------------------------------------- */
+
+/**
+@file   __HAL_TRACE.c
+@brief  Host bus trace capture and replay HAL
+*/
+/**
+@defgroup   JOYSTICK_HAL_TRACE
+@brief      Host Trace Capture / Replay
+@{
+
+Two host-only layers sharing one trace file format :
+
+- __HAL_TRACE__ : capture. __joystick_hal.c renames the I2C and GPIO map
+  functions of the platform HAL ( simulation or Linux ) to hal_traceLower*,
+  this file wraps them and appends every START, write, read, CS / INT get
+  and RST set with its result and a timestamp to the trace opened by
+  hal_traceOpen().
+- __HAL_REPLAY__ : replay HAL, used instead of a platform HAL.
+  hal_replayOpen() loads a trace and the I2C and GPIO calls of the driver
+  are answered from it in order, so the unmodified driver sees exactly the
+  bytes and pin levels of the recorded run.
+
+Trace file : "JTRC", version byte, 3 reserved bytes, then records of
+
+| Bytes | Field                                                           |
+|:-----:|:----------------------------------------------------------------|
+| 4     | microseconds since the previous record, little endian           |
+| 1     | op : 'S' start, 'W' write, 'R' read, 'G' pin get, 'P' pin set   |
+| 1     | slave address, or GPIO slot for pin records                     |
+| 1     | end mode, or pin index for pin records                          |
+| 1     | return value, or pin level for pin records                      |
+| 2     | data length, little endian                                      |
+| n     | bytes written or read                                           |
+
+Replay matches each call with the next record of the same op, address /
+slot, end mode / pin and length, looking ahead up to _HAL_REPLAY_LOOKAHEAD
+records. Skipped records, calls without a match and written bytes that
+differ from the trace are counted in T_hal_replayStats.
+*/
+/* -------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _HAL_TRACE_VERSION          1
+#define _HAL_TRACE_HEADER_SIZE      8
+#define _HAL_TRACE_RECORD_SIZE      10
+#define _HAL_TRACE_GPIO_SLOTS       2
+
+#define _HAL_TRACE_OP_START         'S'
+#define _HAL_TRACE_OP_WRITE         'W'
+#define _HAL_TRACE_OP_READ          'R'
+#define _HAL_TRACE_OP_GET           'G'
+#define _HAL_TRACE_OP_SET           'P'
+
+/* ------------------------------------------------------------------ CAPTURE */
+#ifdef __HAL_TRACE__
+
+#undef hal_i2cMap
+#undef hal_i2cStart
+#undef hal_i2cWrite
+#undef hal_i2cRead
+#undef hal_gpioMap
+
+/** Microsecond clock for trace timestamps */
+typedef uint64_t (*T_hal_traceClockFp)();
+
+static FILE                *hal_traceFile;
+static T_hal_traceClockFp   hal_traceClock;
+static uint64_t             hal_traceLastUs;
+static uint32_t             hal_traceRecords;
+
+/* GPIO objects seen by hal_gpioMap(), the slot of the mapped one tags pin records */
+static T_HAL_P              hal_traceGpioObj[ _HAL_TRACE_GPIO_SLOTS ];
+static uint8_t              hal_traceGpioSlot;
+
+#ifdef __HAL_HOST_SIM__
+static uint64_t hal_tracePlatformClock() { return hal_simTimeUs; }
+#endif
+#ifdef __HAL_LINUX__
+static uint64_t hal_tracePlatformClock() { return hal_linuxTimeUs(); }
+#endif
+
+static void hal_traceRecord( uint8_t op, uint8_t tag, uint8_t arg, uint8_t status, const uint8_t *pBuf, uint16_t nBytes )
+{
+    uint8_t head[ _HAL_TRACE_RECORD_SIZE ];
+    uint64_t now;
+    uint32_t delta;
+
+    if ( !hal_traceFile )
+        return;
+
+    now = hal_traceClock ? hal_traceClock() : hal_traceLastUs;
+    delta = now - hal_traceLastUs > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)( now - hal_traceLastUs );
+    hal_traceLastUs = now;
+
+    head[ 0 ] = (uint8_t)delta;
+    head[ 1 ] = (uint8_t)( delta >> 8 );
+    head[ 2 ] = (uint8_t)( delta >> 16 );
+    head[ 3 ] = (uint8_t)( delta >> 24 );
+    head[ 4 ] = op;
+    head[ 5 ] = tag;
+    head[ 6 ] = arg;
+    head[ 7 ] = status;
+    head[ 8 ] = (uint8_t)nBytes;
+    head[ 9 ] = (uint8_t)( nBytes >> 8 );
+
+    fwrite( head, 1, _HAL_TRACE_RECORD_SIZE, hal_traceFile );
+
+    if ( nBytes )
+        fwrite( pBuf, 1, nBytes, hal_traceFile );
+
+    hal_traceRecords++;
+}
+
+/**
+ * Start capture into path, timestamps from clockUs ( 0 : virtual time of
+ * the simulation HAL, monotonic time of the Linux HAL, or no timestamps ).
+ * Returns 0 on success.
+ */
+static int hal_traceOpen( const char *path, T_hal_traceClockFp clockUs )
+{
+    static const uint8_t header[ _HAL_TRACE_HEADER_SIZE ] = { 'J', 'T', 'R', 'C', _HAL_TRACE_VERSION, 0, 0, 0 };
+
+    hal_traceFile = fopen( path, "wb" );
+
+    if ( !hal_traceFile )
+        return 1;
+
+    hal_traceClock = clockUs;
+#if defined( __HAL_HOST_SIM__ ) || defined( __HAL_LINUX__ )
+    if ( !hal_traceClock )
+        hal_traceClock = hal_tracePlatformClock;
+#endif
+    hal_traceLastUs = hal_traceClock ? hal_traceClock() : 0;
+    hal_traceRecords = 0;
+
+    fwrite( header, 1, _HAL_TRACE_HEADER_SIZE, hal_traceFile );
+
+    return 0;
+}
+
+/** Stop capture, returns number of records written */
+static uint32_t hal_traceClose()
+{
+    if ( hal_traceFile )
+        fclose( hal_traceFile );
+
+    hal_traceFile = 0;
+
+    return hal_traceRecords;
+}
+
+static void hal_i2cMap(T_HAL_P i2cObj)
+{
+    hal_traceLowerI2cMap( i2cObj );
+}
+
+static int hal_i2cStart(void)
+{
+    int ret = hal_traceLowerI2cStart();
+
+    hal_traceRecord( _HAL_TRACE_OP_START, 0, 0, (uint8_t)ret, 0, 0 );
+
+    return ret;
+}
+
+static int hal_i2cWrite(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    int ret = hal_traceLowerI2cWrite( slaveAddress, pBuf, nBytes, endMode );
+
+    hal_traceRecord( _HAL_TRACE_OP_WRITE, slaveAddress, endMode, (uint8_t)ret, pBuf, nBytes );
+
+    return ret;
+}
+
+static int hal_i2cRead(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    int ret = hal_traceLowerI2cRead( slaveAddress, pBuf, nBytes, endMode );
+
+    hal_traceRecord( _HAL_TRACE_OP_READ, slaveAddress, endMode, (uint8_t)ret, pBuf, nBytes );
+
+    return ret;
+}
+
+/* Pins used by the driver, wrapped around the functions mapped by the platform HAL */
+static T_hal_gpioGetFp hal_traceCsGet;
+static T_hal_gpioGetFp hal_traceIntGet;
+static T_hal_gpioSetFp hal_traceRstSet;
+
+static uint8_t hal_traceCsThunk()
+{
+    uint8_t level = hal_traceCsGet();
+
+    hal_traceRecord( _HAL_TRACE_OP_GET, hal_traceGpioSlot, __CS_PIN_INPUT__, level, 0, 0 );
+
+    return level;
+}
+
+static uint8_t hal_traceIntThunk()
+{
+    uint8_t level = hal_traceIntGet();
+
+    hal_traceRecord( _HAL_TRACE_OP_GET, hal_traceGpioSlot, __INT_PIN_INPUT__, level, 0, 0 );
+
+    return level;
+}
+
+static void hal_traceRstThunk( uint8_t state )
+{
+    hal_traceRstSet( state );
+
+    hal_traceRecord( _HAL_TRACE_OP_SET, hal_traceGpioSlot, __RST_PIN_OUTPUT__, state, 0, 0 );
+}
+
+static void hal_gpioMap(T_HAL_P gpioObj)
+{
+    uint8_t i;
+
+    hal_traceLowerGpioMap( gpioObj );
+
+    for ( i = 0; i < _HAL_TRACE_GPIO_SLOTS - 1; i++ )
+        if ( !hal_traceGpioObj[ i ] || hal_traceGpioObj[ i ] == gpioObj )
+            break;
+
+    hal_traceGpioObj[ i ] = gpioObj;
+    hal_traceGpioSlot = i;
+
+    hal_traceCsGet = hal_gpio_csGet;
+    hal_traceIntGet = hal_gpio_intGet;
+    hal_traceRstSet = hal_gpio_rstSet;
+
+    hal_gpio_csGet = hal_traceCsThunk;
+    hal_gpio_intGet = hal_traceIntThunk;
+    hal_gpio_rstSet = hal_traceRstThunk;
+}
+
+#endif
+/* ------------------------------------------------------------------- REPLAY */
+#ifdef __HAL_REPLAY__
+
+#define END_MODE_RESTART            0
+#define END_MODE_STOP               1
+
+#define _HAL_REPLAY_LOOKAHEAD       16
+
+/** Parsed trace record, data points into the loaded file */
+typedef struct
+{
+    uint64_t            timeUs;
+    uint8_t             op;
+    uint8_t             tag;
+    uint8_t             arg;
+    uint8_t             status;
+    uint16_t            len;
+    const uint8_t      *data;
+
+}T_hal_replayRecord;
+
+/** Replay divergence counters */
+typedef struct
+{
+    uint32_t            consumed;
+    uint32_t            skipped;
+    uint32_t            missed;
+    uint32_t            dataMismatches;
+
+}T_hal_replayStats;
+
+static uint8_t             *hal_replayFile;
+static T_hal_replayRecord  *hal_replayRecords;
+static uint32_t             hal_replayCount;
+static uint32_t             hal_replayCursor;
+static uint64_t             hal_replayNowUs;
+static T_hal_replayStats    hal_replayStats;
+
+/** Load trace, returns number of records or -1 on a missing / malformed file */
+static long hal_replayOpen( const char *path )
+{
+    FILE *f;
+    long size;
+    long pos;
+    uint32_t n;
+    uint64_t t;
+    uint32_t delta;
+    const uint8_t *p;
+
+    f = fopen( path, "rb" );
+
+    if ( !f )
+        return -1;
+
+    fseek( f, 0, SEEK_END );
+    size = ftell( f );
+    fseek( f, 0, SEEK_SET );
+
+    free( hal_replayFile );
+    free( hal_replayRecords );
+    hal_replayFile = (uint8_t*)malloc( size > 0 ? size : 1 );
+    hal_replayRecords = 0;
+    hal_replayCount = 0;
+
+    if ( !hal_replayFile || fread( hal_replayFile, 1, size, f ) != (size_t)size )
+    {
+        fclose( f );
+        return -1;
+    }
+
+    fclose( f );
+
+    if ( size < _HAL_TRACE_HEADER_SIZE || memcmp( hal_replayFile, "JTRC", 4 ) || hal_replayFile[ 4 ] != _HAL_TRACE_VERSION )
+        return -1;
+
+    // first pass counts, second pass fills; a record cut off at the end ( capture aborted ) is dropped
+    for ( n = 0, pos = _HAL_TRACE_HEADER_SIZE; pos + _HAL_TRACE_RECORD_SIZE <= size; n++ )
+    {
+        long next = pos + _HAL_TRACE_RECORD_SIZE + ( hal_replayFile[ pos + 8 ] | ( hal_replayFile[ pos + 9 ] << 8 ) );
+
+        if ( next > size )
+            break;
+
+        pos = next;
+    }
+
+    size = pos;
+
+    hal_replayRecords = (T_hal_replayRecord*)malloc( ( n ? n : 1 ) * sizeof( T_hal_replayRecord ) );
+
+    if ( !hal_replayRecords )
+        return -1;
+
+    t = 0;
+
+    for ( n = 0, pos = _HAL_TRACE_HEADER_SIZE; pos < size; n++ )
+    {
+        p = &hal_replayFile[ pos ];
+        delta = p[ 0 ] | ( p[ 1 ] << 8 ) | ( (uint32_t)p[ 2 ] << 16 ) | ( (uint32_t)p[ 3 ] << 24 );
+        t += delta;
+
+        hal_replayRecords[ n ].timeUs = t;
+        hal_replayRecords[ n ].op = p[ 4 ];
+        hal_replayRecords[ n ].tag = p[ 5 ];
+        hal_replayRecords[ n ].arg = p[ 6 ];
+        hal_replayRecords[ n ].status = p[ 7 ];
+        hal_replayRecords[ n ].len = p[ 8 ] | ( p[ 9 ] << 8 );
+        hal_replayRecords[ n ].data = p + _HAL_TRACE_RECORD_SIZE;
+
+        pos += _HAL_TRACE_RECORD_SIZE + hal_replayRecords[ n ].len;
+    }
+
+    hal_replayCount = n;
+    hal_replayCursor = 0;
+    hal_replayNowUs = 0;
+    memset( &hal_replayStats, 0, sizeof( hal_replayStats ) );
+
+    return (long)n;
+}
+
+/** 1 once every record of the trace was consumed */
+static uint8_t hal_replayEnded()
+{
+    return hal_replayCursor >= hal_replayCount;
+}
+
+/**
+ * Time source for joystick_setTimeSource() : the time of the next record,
+ * i.e. the time the recorded run made its next bus access.
+ */
+static uint32_t hal_replayTimeUs()
+{
+    if ( hal_replayCursor < hal_replayCount )
+        return (uint32_t)hal_replayRecords[ hal_replayCursor ].timeUs;
+
+    // past the end time keeps running so busy-waits finish
+    hal_replayNowUs += 1000;
+
+    return (uint32_t)hal_replayNowUs;
+}
+
+/** Next record matching the call, 0 when none within the lookahead window */
+static const T_hal_replayRecord *hal_replayMatch( uint8_t op, uint8_t tag, uint8_t arg, uint16_t len )
+{
+    const T_hal_replayRecord *rec;
+    uint32_t i;
+
+    for ( i = hal_replayCursor; i < hal_replayCount && i < hal_replayCursor + _HAL_REPLAY_LOOKAHEAD; i++ )
+    {
+        rec = &hal_replayRecords[ i ];
+
+        if ( rec->op == op && rec->tag == tag && rec->arg == arg && rec->len == len )
+        {
+            hal_replayStats.skipped += i - hal_replayCursor;
+            hal_replayStats.consumed++;
+            hal_replayCursor = i + 1;
+            hal_replayNowUs = rec->timeUs;
+
+            return rec;
+        }
+    }
+
+    hal_replayStats.missed++;
+
+    return 0;
+}
+
+/* Compiler built-in delays, time is taken from the trace */
+void Delay_10us()  { }
+void Delay_1ms()   { }
+void Delay_10ms()  { }
+void Delay_100ms() { }
+
+static void hal_i2cMap(T_HAL_P i2cObj)
+{
+    (void)i2cObj;
+}
+
+static int hal_i2cStart(void)
+{
+    const T_hal_replayRecord *rec = hal_replayMatch( _HAL_TRACE_OP_START, 0, 0, 0 );
+
+    return rec ? rec->status : 1;
+}
+
+static int hal_i2cWrite(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    const T_hal_replayRecord *rec = hal_replayMatch( _HAL_TRACE_OP_WRITE, slaveAddress, endMode, nBytes );
+
+    if ( !rec )
+        return 1;
+
+    if ( nBytes && memcmp( rec->data, pBuf, nBytes ) )
+        hal_replayStats.dataMismatches++;
+
+    return rec->status;
+}
+
+static int hal_i2cRead(uint8_t slaveAddress, uint8_t *pBuf, uint16_t nBytes, uint8_t endMode)
+{
+    const T_hal_replayRecord *rec = hal_replayMatch( _HAL_TRACE_OP_READ, slaveAddress, endMode, nBytes );
+
+    if ( !rec )
+    {
+        memset( pBuf, 0, nBytes );
+        return 1;
+    }
+
+    memcpy( pBuf, rec->data, nBytes );
+
+    return rec->status;
+}
+
+/* Pin level from the trace, idle level when the call has no match */
+static uint8_t hal_replayPinGet( uint8_t slot, uint8_t pin, uint8_t idle )
+{
+    const T_hal_replayRecord *rec = hal_replayMatch( _HAL_TRACE_OP_GET, slot, pin, 0 );
+
+    return rec ? rec->status : idle;
+}
+
+static uint8_t hal_replayCsGet0() { return hal_replayPinGet( 0, __CS_PIN_INPUT__, 0 ); }
+static uint8_t hal_replayCsGet1() { return hal_replayPinGet( 1, __CS_PIN_INPUT__, 0 ); }
+static uint8_t hal_replayIntGet0() { return hal_replayPinGet( 0, __INT_PIN_INPUT__, 1 ); }
+static uint8_t hal_replayIntGet1() { return hal_replayPinGet( 1, __INT_PIN_INPUT__, 1 ); }
+static void hal_replayRstSet0( uint8_t state ) { (void)state; hal_replayMatch( _HAL_TRACE_OP_SET, 0, __RST_PIN_OUTPUT__, 0 ); }
+static void hal_replayRstSet1( uint8_t state ) { (void)state; hal_replayMatch( _HAL_TRACE_OP_SET, 1, __RST_PIN_OUTPUT__, 0 ); }
+static uint8_t hal_replayPinLow() { return 0; }
+static void hal_replayPinNone( uint8_t state ) { (void)state; }
+
+/** Fill GPIO object with the pins recorded for GPIO slot 0 or 1 */
+static void hal_replayGpioObj( T_hal_gpioObj *gpio, uint8_t slot )
+{
+    uint8_t i;
+
+    slot &= 1;
+
+    for ( i = 0; i < 12; i++ )
+    {
+        gpio->gpioGet[ i ] = hal_replayPinLow;
+        gpio->gpioSet[ i ] = hal_replayPinNone;
+    }
+
+    gpio->gpioGet[ __CS_PIN_INPUT__ ] = slot ? hal_replayCsGet1 : hal_replayCsGet0;
+    gpio->gpioGet[ __INT_PIN_INPUT__ ] = slot ? hal_replayIntGet1 : hal_replayIntGet0;
+    gpio->gpioSet[ __RST_PIN_OUTPUT__ ] = slot ? hal_replayRstSet1 : hal_replayRstSet0;
+}
+
+#endif
+                                                                       /** @} */
+/* -------------------------------------------------------------------------- */
+/*
+  __HAL_TRACE.c
+
+  Copyright (c) 2017, MikroElektonika - http://www.mikroe.com
+
+  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+3. All advertising materials mentioning features or use of this software
+   must display the following acknowledgement:
+   This product includes software developed by the MikroElektonika.
+
+4. Neither the name of the MikroElektonika nor the
+   names of its contributors may be used to endorse or promote products
+   derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY MIKROELEKTRONIKA ''AS IS'' AND ANY
+EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL MIKROELEKTRONIKA BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------------- */
@@ -14,17 +14,105 @@
 #include "__joystick_driver.h"
 #include "__joystick_hal.c"
 
+
 /* ------------------------------------------------------------------- MACROS */
 
+/* Self-clearing Soft_rst bit of Control register 1 */
+#define _JOYSTICK_CONTROL1_SOFT_RST     0x80
 
+/* Bit 3 of Control register 1, set by every driver write */
+#define _JOYSTICK_CONTROL1_BIT3         0x08
 
-/* ---------------------------------------------------------------- VARIABLES */
+/* Interrupt output enable bit of Control register 1 */
+#define _JOYSTICK_CONTROL1_INT_EN       0x04
 
-#ifdef   __JOYSTICK_DRV_I2C__
-static uint8_t _slaveAddress;
+/* Index mask of the event mode sample ring */
+#define _JOYSTICK_RING_MASK             ( _JOYSTICK_RING_SIZE - 1 )
+
+/* Default thresholds of the direction classifier */
+#define _JOYSTICK_DEFAULT_LOW_THRESHOLD     20
+#define _JOYSTICK_DEFAULT_HIGH_THRESHOLD    60
+#define _JOYSTICK_DEFAULT_HYSTERESIS        4
+
+/* Bus cost counters, compiled out without __JOYSTICK_STATS__ */
+#ifdef __JOYSTICK_STATS__
+#define _JOYSTICK_STAT_ADD( ctx, field, n )     ( (ctx)->stats.field += (n) )
+#else
+#define _JOYSTICK_STAT_ADD( ctx, field, n )
+#endif
+
+/* CORDIC iterations and gain compensation 1 / 1.6468 in Q15 */
+#define _JOYSTICK_CORDIC_STEPS          15
+#define _JOYSTICK_CORDIC_GAIN_Q15       19898
+
+/* Calibration : blob version, smallest extent, center averaging, default decay */
+#define _JOYSTICK_CALIB_VERSION         0xC1
+#define _JOYSTICK_CALIB_MIN_EXTENT      ( 16 << 8 )
+#define _JOYSTICK_CALIB_CENTER_SHIFT    6
+#define _JOYSTICK_CALIB_DEFAULT_DECAY   8
+
+/* Filter defaults */
+#define _JOYSTICK_FILTER_DEFAULT_SHIFT  2
+#define _JOYSTICK_FILTER_DEFAULT_MIN    16
+#define _JOYSTICK_FILTER_DEFAULT_BETA   32
+
+/* Button engine defaults */
+#define _JOYSTICK_BUTTON_DEFAULT_TICK_US        1000
+#define _JOYSTICK_BUTTON_DEFAULT_DEBOUNCE       10
+#define _JOYSTICK_BUTTON_DEFAULT_LONG_PRESS     800
+#define _JOYSTICK_BUTTON_DEFAULT_DOUBLE_CLICK   300
+
+/* Adaptive rate defaults, a fixed 10 ms period */
+#define _JOYSTICK_RATE_DEFAULT_PERIOD   10
+#define _JOYSTICK_RATE_DEFAULT_DELTA    4
+#define _JOYSTICK_RATE_DEFAULT_IDLE     8
+
+/* Index mask of the button event queue */
+#define _JOYSTICK_BUTTON_QUEUE_MASK     ( _JOYSTICK_BUTTON_QUEUE_SIZE - 1 )
+
+/* Event logger : ring index mask, text row length, text index of the final line feed */
+#define _JOYSTICK_LOG_MASK              ( _JOYSTICK_LOG_SIZE - 1 )
+#define _JOYSTICK_LOG_TEXT_SIZE         16
+#define _JOYSTICK_LOG_LF                0xFF
+
+/* Telemetry frame : sync byte, flag bits */
+#define _JOYSTICK_TELEMETRY_SYNC        0xA5
+#define _JOYSTICK_TELEMETRY_BUTTON      0x01
+#define _JOYSTICK_TELEMETRY_KEY         0x02
+
+/* Orders ring slot accesses against index updates on hosts with reordering compilers / CPUs */
+#ifdef __GNUC__
+#define _JOYSTICK_BARRIER()             __sync_synchronize()
+#else
+#define _JOYSTICK_BARRIER()
 #endif
 
 
+/* ---------------------------------------------------------------- VARIABLES */
+
+/* Instance used by the global ( context-less ) API */
+static T_joystick_ctx _joystick_defaultCtx;
+
+/* Instance whose I2C and GPIO objects are currently mapped to the HAL, per thread with __HAL_THREADS__ */
+static HAL_TLS T_joystick_ctx *_activeCtx;
+
+/* Cooperative task runner */
+static T_joystick_task _joystick_tasks[ _JOYSTICK_TASK_MAX ];
+static uint8_t _joystick_taskCount;
+static volatile uint8_t _joystick_taskTicks;
+static uint8_t _joystick_taskLast;
+
+/* Event logger */
+static T_joystick_logRecord _joystick_logRing[ _JOYSTICK_LOG_SIZE ];
+static volatile uint8_t _joystick_logHead;
+static volatile uint8_t _joystick_logTail;
+static volatile uint8_t _joystick_logBusy;
+static uint16_t _joystick_logDropped;
+static T_joystick_logKickFp _joystick_logKick;
+static T_joystick_logRecord _joystick_logTx;
+static uint8_t _joystick_logTxIndex;
+static uint8_t _joystick_logTxActive;
+
 /* Device I2C Address */
 //    J1 is in position 0
 const uint8_t _JOYSTICK_I2C_ADDRESS_0                                    = 0x40;
@@ -76,277 +164,2142 @@ const uint8_t _JOYSTICK_CONTROL1_RESET_CMD                               = 0x88;
 // Invert the channel voltage
 const uint8_t _JOYSTICK_INVERT_SPINING_CMD                               = 0x86;
 
+/* Joystick Position */
+const uint8_t _JOYSTICK_POSITION_START                                   = 0;
+const uint8_t _JOYSTICK_POSITION_TOP                                     = 1;
+const uint8_t _JOYSTICK_POSITION_TOP_RIGHT                               = 2;
+const uint8_t _JOYSTICK_POSITION_RIGHT                                   = 3;
+const uint8_t _JOYSTICK_POSITION_BOTTOM_RIGHT                            = 4;
+const uint8_t _JOYSTICK_POSITION_BOTTOM                                  = 5;
+const uint8_t _JOYSTICK_POSITION_BOTTOM_LEFT                             = 6;
+const uint8_t _JOYSTICK_POSITION_LEFT                                    = 7;
+const uint8_t _JOYSTICK_POSITION_TOP_LEFT                                = 8;
 
+/*
+ * Position of every ( Y zone, X zone ) pair, generated by host/joystick_zonegen.c.
+ * Zones per axis: 0 <= -high < 1 <= -low < 2 < low <= 3 < high <= 4.
+ * Negative X is right, negative Y is bottom. An axis alone past the low threshold
+ * gives its cardinal direction, both axes in the same band give the diagonal,
+ * a strong axis with a weak one gives the cardinal direction of the strong one.
+ */
+const uint8_t _JOYSTICK_ZONE_TABLE[ 5 ][ 5 ] =
+{
+    { 4, 5, 5, 5, 6 },
+    { 3, 4, 5, 6, 7 },
+    { 3, 3, 0, 7, 7 },
+    { 3, 2, 1, 8, 7 },
+    { 2, 1, 1, 1, 8 }
+};
 
-/* -------------------------------------------- PRIVATE FUNCTION DECLARATIONS */
 
 
+/* arctan( 2^-i ) in binary angle units, 32768 = 180 degrees */
+const int16_t _JOYSTICK_CORDIC_ATAN[ _JOYSTICK_CORDIC_STEPS ] =
+{
+    8192, 4836, 2555, 1297, 651, 326, 163, 81, 41, 20, 10, 5, 3, 1, 1
+};
+
+/* Calibration Mode */
+const uint8_t _JOYSTICK_CALIBRATION_OFF                                  = 0;
+const uint8_t _JOYSTICK_CALIBRATION_APPLY                                = 1;
+const uint8_t _JOYSTICK_CALIBRATION_LEARN                                = 2;
+
+/* Filter Type */
+const uint8_t _JOYSTICK_FILTER_NONE                                      = 0;
+const uint8_t _JOYSTICK_FILTER_IIR                                       = 1;
+const uint8_t _JOYSTICK_FILTER_MEDIAN3                                   = 2;
+const uint8_t _JOYSTICK_FILTER_MEDIAN5                                   = 3;
+const uint8_t _JOYSTICK_FILTER_ADAPTIVE                                  = 4;
+
+/* Button Event */
+const uint8_t _JOYSTICK_BUTTON_PRESS                                     = 1;
+const uint8_t _JOYSTICK_BUTTON_RELEASE                                   = 2;
+const uint8_t _JOYSTICK_BUTTON_LONG_PRESS                                = 3;
+const uint8_t _JOYSTICK_BUTTON_DOUBLE_CLICK                              = 4;
+
+/* Log Record Type */
+const uint8_t _JOYSTICK_LOG_POSITION                                     = 1;
+const uint8_t _JOYSTICK_LOG_BUTTON                                       = 2;
+
+/* Log lines, indexed by position and by button event type */
+const char _JOYSTICK_LOG_POSITION_TEXT[ 9 ][ _JOYSTICK_LOG_TEXT_SIZE ] =
+{
+    "Start position", "Top", "Top-Right", "Right", "Bottom-Right",
+    "Bottom", "Bottom-Left", "Left", "Top-Left"
+};
 
-/* --------------------------------------------- PRIVATE FUNCTION DEFINITIONS */
+const char _JOYSTICK_LOG_BUTTON_TEXT[ 5 ][ _JOYSTICK_LOG_TEXT_SIZE ] =
+{
+    "", "Button pressed", "Button released", "Long press", "Double click"
+};
 
+/* Low power timebase periods in ms, indexed by Control register 1 bits 6:4 */
+const uint16_t _JOYSTICK_LOW_POWER_PERIOD[ 8 ] =
+{
+    20, 40, 80, 100, 140, 200, 260, 320
+};
 
+/* -------------------------------------------- PRIVATE FUNCTION DECLARATIONS */
 
-/* --------------------------------------------------------- PUBLIC FUNCTIONS */
+static void _joystick_select( T_joystick_ctx *ctx );
 
-#ifdef   __JOYSTICK_DRV_SPI__
+static void _joystick_restore( T_joystick_ctx *ctx );
 
-void joystick_spiDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P spiObj)
-{
-    hal_spiMap( (T_HAL_P)spiObj );
-    hal_gpioMap( (T_HAL_P)gpioObj );
+static uint8_t _joystick_shadowIndex( uint8_t registerAddress );
 
-    // ... power ON
-    // ... configure CHIP
-}
+static uint8_t _joystick_readConfig( T_joystick_ctx *ctx, uint8_t registerAddress );
 
-#endif
-#ifdef   __JOYSTICK_DRV_I2C__
+static uint8_t _joystick_zone( int16_t value, int16_t lo, int16_t hi );
 
-void joystick_i2cDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P i2cObj, uint8_t slave)
-{
-    _slaveAddress = slave;
-    hal_i2cMap( (T_HAL_P)i2cObj );
-    hal_gpioMap( (T_HAL_P)gpioObj );
+static uint8_t _joystick_zoneHysteresis( int16_t value, uint8_t previous, int16_t lo, int16_t hi, int16_t hysteresis );
 
-    hal_gpio_rstSet( 1 );
-}
+static void _joystick_buttonEmit( T_joystick_ctx *ctx, uint8_t type );
 
-#endif
-#ifdef   __JOYSTICK_DRV_UART__
+static char _joystick_logChar( T_joystick_logRecord *rec, uint8_t index );
 
-void joystick_uartDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P uartObj)
-{
-    hal_uartMap( (T_HAL_P)uartObj );
-    hal_gpioMap( (T_HAL_P)gpioObj );
+#ifdef __JOYSTICK_TELEMETRY__
+static uint8_t _joystick_crc8( const uint8_t *buf, uint8_t len );
 
-    // ... power ON
-    // ... configure CHIP
-}
+static uint8_t _joystick_varintPut( uint8_t *buf, uint32_t value );
 
+static uint8_t _joystick_varintGet( const uint8_t *buf, uint8_t len, uint8_t maxBytes, uint32_t *value );
+
+static uint8_t _joystick_telemetryParse( T_joystick_telemetryDecoder *dec, T_joystick_record *record );
 #endif
 
+static void _joystick_cordic( int16_t x, int16_t y, uint16_t *magnitude, int16_t *angle );
 
+static void _joystick_calibExtent( T_joystick_calib *cal, uint8_t idx, uint16_t deviation );
 
-/* ----------------------------------------------------------- IMPLEMENTATION */
+static void _joystick_calibLearn( T_joystick_ctx *ctx, int8_t ox, int8_t oy );
 
+static int8_t _joystick_calibApply( T_joystick_calib *cal, int8_t value, int16_t center, uint8_t idx );
 
-/* Generic write 8-bit data to register function */
-void joystick_writeByte( uint8_t registerAddress, uint8_t dataWrite )
-{
-    uint8_t buffer[ 2 ];
-  
-    buffer[ 0 ] = registerAddress;
-    buffer[ 1 ] = dataWrite;
-  
-    hal_i2cStart();
-    hal_i2cWrite( _slaveAddress, buffer, 2 , END_MODE_STOP );
-}
+static int8_t _joystick_median3( int8_t a, int8_t b, int8_t c );
 
-/* Generic read 8-bit data from register function */
-int8_t joystick_readByte( uint8_t registerAddress )
-{
-    uint8_t writeReg[ 1 ];
-    uint8_t readReg[ 1 ];
-    int8_t result;
+static int8_t _joystick_median5( const int8_t *h );
 
-    writeReg[ 0 ] = registerAddress;
+static int8_t _joystick_filterAxis( T_joystick_filter *flt, T_joystick_filterAxis *axis, int8_t value );
 
-    hal_i2cStart();
-    hal_i2cWrite( _slaveAddress, writeReg, 1, END_MODE_RESTART );
-    hal_i2cRead( _slaveAddress, readReg, 1, END_MODE_STOP );
-    
-    result = readReg[ 0 ];
 
-    return result;
-}
+/* --------------------------------------------- PRIVATE FUNCTION DEFINITIONS */
 
-/* Set default configuration function */
-void joystick_setDefaultConfiguration()
+/* Maps HAL function pointers to the bus and pins of the instance, only when the instance changes */
+static void _joystick_select( T_joystick_ctx *ctx )
 {
-    uint8_t tempData;
+    if ( ctx == _activeCtx )
+        return;
 
-    joystick_writeByte( _JOYSTICK_CONTROL2, _JOYSTICK_CONTROL2_TEST_CMD );
-  
-    joystick_writeByte( _JOYSTICK_AGC, _JOYSTICK_AGC_MAX_SENSITIVITY_CMD );
-  
-    joystick_writeByte( _JOYSTICK_T_CTRL, _JOYSTICK_T_CTRL_SCALING_90_8_CMD );
-  
-    tempData = joystick_readByte( _JOYSTICK_CONTROL1 );
-    tempData &= 0x01;
-    
-    joystick_writeByte( _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | tempData );
+    // marked first : an interrupt handler restoring this instance finishes a mapping it cut short
+    _activeCtx = ctx;
+
+    hal_i2cMap( (T_HAL_P)ctx->i2cObj );
+    hal_gpioMap( (T_HAL_P)ctx->gpioObj );
 }
 
-/* Check sensor ID code function */
-uint8_t joystick_checkIdCode()
+/* Maps back the instance that was active before an interrupt handler selected its own */
+static void _joystick_restore( T_joystick_ctx *ctx )
 {
-    return ( joystick_readByte( _JOYSTICK_ID_CODE ) == _JOYSTICK_ID_CODE ) ? 1 : 0;
+    if ( ctx )
+        _joystick_select( ctx );
 }
 
-/* Check sensor ID version function */
-uint8_t joystick_checkIdVersion()
+/* Returns shadow slot of configuration register or 0xFF if register is not shadowed */
+static uint8_t _joystick_shadowIndex( uint8_t registerAddress )
 {
-    return ( joystick_readByte( _JOYSTICK_ID_VERSION ) == _JOYSTICK_ID_VERSION ) ? 1 : 0;
+    if ( registerAddress == _JOYSTICK_CONTROL1 )
+        return 0;
+    if ( registerAddress == _JOYSTICK_CONTROL2 )
+        return 1;
+    if ( registerAddress == _JOYSTICK_AGC )
+        return 2;
+    if ( registerAddress == _JOYSTICK_M_CTRL )
+        return 3;
+    if ( registerAddress == _JOYSTICK_J_CTRL )
+        return 4;
+    if ( registerAddress == _JOYSTICK_T_CTRL )
+        return 5;
+
+    return 0xFF;
 }
 
-/* Set Low Power Mode function */
-void joystick_setLowPowerMode( uint8_t timings )
+/* Returns configuration register value from shadow, reads it over I2C only when shadow is not coherent */
+static uint8_t _joystick_readConfig( T_joystick_ctx *ctx, uint8_t registerAddress )
 {
-    uint8_t tempData;
-    
-    timings %= 8;
+    uint8_t idx;
 
-    tempData = joystick_readByte( _JOYSTICK_CONTROL1 );
-    tempData &= 0x7F;
-    tempData |= timings << 4;
+    idx = _joystick_shadowIndex( registerAddress );
 
-    joystick_writeByte( _JOYSTICK_CONTROL1, tempData );
+    if ( idx == 0xFF )
+        return joystick_ctxReadByte( ctx, registerAddress );
+
+    if ( ( ctx->shadowValid & ( 1 << idx ) ) == 0 )
+    {
+        ctx->shadow[ idx ] = joystick_ctxReadByte( ctx, registerAddress );
+        ctx->shadowValid |= 1 << idx;
+    }
+
+    return ctx->shadow[ idx ];
 }
 
-/* Set scaling factor function */
-void joystick_setScalingFactor( uint8_t scalingFactor )
+
+/* Zone of one axis : 0 <= -hi < 1 <= -lo < 2 < lo <= 3 < hi <= 4 */
+static uint8_t _joystick_zone( int16_t value, int16_t lo, int16_t hi )
 {
-    if ( scalingFactor < 32 )
-        joystick_writeByte( _JOYSTICK_T_CTRL, scalingFactor );
-    else
-        joystick_writeByte( _JOYSTICK_T_CTRL, _JOYSTICK_T_CTRL_SCALING_100_CMD );
+    return ( value > -hi ) + ( value > -lo ) + ( value >= lo ) + ( value >= hi );
 }
 
-/* Set interrupt disabled function */
-void joystick_disabledInterrupt()
+/* Keeps the previous zone while the value is within hysteresis of it */
+static uint8_t _joystick_zoneHysteresis( int16_t value, uint8_t previous, int16_t lo, int16_t hi, int16_t hysteresis )
 {
-    uint8_t tempData;
+    if ( previous >= _joystick_zone( value - hysteresis, lo, hi ) &&
+         previous <= _joystick_zone( value + hysteresis, lo, hi ) )
+        return previous;
 
-    tempData = joystick_readByte( _JOYSTICK_CONTROL1 );
-    tempData &= 0x04;
-
-    joystick_writeByte( _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | tempData );
+    return _joystick_zone( value, lo, hi );
 }
 
-/* Set interrupt enabled function */
-void joystick_enabledInterrupt()
+/* Queues a button event stamped with the time source or the tick count */
+static void _joystick_buttonEmit( T_joystick_ctx *ctx, uint8_t type )
 {
-    uint8_t tempData;
+    T_joystick_button *btn;
+    T_joystick_buttonEvent *slot;
+    uint8_t head;
 
-    tempData = joystick_readByte( _JOYSTICK_CONTROL1 );
-    tempData |= 0x04;
+    btn = &ctx->button;
+    head = btn->queueHead;
 
-    joystick_writeByte( _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | tempData );
+    if ( (uint8_t)( head - btn->queueTail ) >= _JOYSTICK_BUTTON_QUEUE_SIZE )
+    {
+        btn->queueDropped++;
+        return;
+    }
+
+    slot = &btn->queue[ head & _JOYSTICK_BUTTON_QUEUE_MASK ];
+    slot->type = type;
+
+    if ( ctx->timeSource )
+        slot->timestamp = ctx->timeSource();
+    else
+        slot->timestamp = btn->ticks * btn->tickUs;
+
+    _JOYSTICK_BARRIER();
+    btn->queueHead = head + 1;
 }
 
-/* Invert the channel voltage function */
-void joystick_invertSpinning()
+/* Character of the log line of a record, 0 past its end */
+static char _joystick_logChar( T_joystick_logRecord *rec, uint8_t index )
 {
-    joystick_writeByte( _JOYSTICK_CONTROL2, _JOYSTICK_INVERT_SPINING_CMD );
+    if ( index >= _JOYSTICK_LOG_TEXT_SIZE )
+        return 0;
+
+    if ( rec->type == _JOYSTICK_LOG_POSITION && rec->value < 9 )
+        return _JOYSTICK_LOG_POSITION_TEXT[ rec->value ][ index ];
+
+    if ( rec->type == _JOYSTICK_LOG_BUTTON && rec->value < 5 )
+        return _JOYSTICK_LOG_BUTTON_TEXT[ rec->value ][ index ];
+
+    return 0;
 }
 
-/* Get joystick position function */
-uint8_t joystick_getPosition()
+#ifdef __JOYSTICK_TELEMETRY__
+
+/* CRC-8, polynomial 0x07, initial value 0 */
+static uint8_t _joystick_crc8( const uint8_t *buf, uint8_t len )
 {
-    int8_t ox;
-    int8_t oy;
-    uint8_t position;
-    
-    position = 0;
+    uint8_t crc;
+    uint8_t i;
 
-    ox = joystick_readByte( _JOYSTICK_X );
-    Delay_10us();
-    oy = joystick_readByte( _JOYSTICK_Y_RES_INT );
-    Delay_10us();
-    
-    if ( ox <= -60 )
+    crc = 0;
+
+    while ( len-- )
     {
-            // right
-            position = 3;
+        crc ^= *buf++;
+
+        for ( i = 0; i < 8; i++ )
+        {
+            if ( crc & 0x80 )
+                crc = ( crc << 1 ) ^ 0x07;
+            else
+                crc <<= 1;
+        }
     }
-    
-    if ( ox >= 60 )
+
+    return crc;
+}
+
+/* Unsigned LEB128, 7 bits per byte, returns number of bytes written */
+static uint8_t _joystick_varintPut( uint8_t *buf, uint32_t value )
+{
+    uint8_t n;
+
+    n = 0;
+
+    while ( value >= 0x80 )
     {
-            // left
-            position = 7;
+        buf[ n++ ] = (uint8_t)value | 0x80;
+        value >>= 7;
     }
-    
-    if ( oy >= 60 )
+
+    buf[ n++ ] = (uint8_t)value;
+
+    return n;
+}
+
+/* Returns number of bytes read, 0 when more bytes are needed, 0xFF when longer than maxBytes */
+static uint8_t _joystick_varintGet( const uint8_t *buf, uint8_t len, uint8_t maxBytes, uint32_t *value )
+{
+    uint8_t n;
+
+    *value = 0;
+
+    for ( n = 0; n < maxBytes; n++ )
     {
-        if ( ox < 20 && ox >= -20 )
-        {
-            // top
-            position = 1;
-        }
+        if ( n >= len )
+            return 0;
+
+        *value |= (uint32_t)( buf[ n ] & 0x7F ) << ( 7 * n );
+
+        if ( !( buf[ n ] & 0x80 ) )
+            return n + 1;
     }
-    
-    if ( oy <= -60 )
+
+    return 0xFF;
+}
+
+/*
+ * Parses the frame at the start of the decoder buffer.
+ * Returns its length, 0 when more bytes are needed, 0xFF when it is invalid.
+ */
+static uint8_t _joystick_telemetryParse( T_joystick_telemetryDecoder *dec, T_joystick_record *record )
+{
+    uint32_t field[ 3 ];
+    uint8_t pos;
+    uint8_t n;
+    uint8_t i;
+
+    if ( dec->len < 3 )
+        return 0;
+
+    if ( dec->buf[ 2 ] & ~( _JOYSTICK_TELEMETRY_BUTTON | _JOYSTICK_TELEMETRY_KEY ) )
+        return 0xFF;
+
+    pos = 3;
+
+    // timestamp up to 5 bytes, X and Y changes up to 2, so a frame fits the buffer
+    for ( i = 0; i < 3; i++ )
     {
-        if ( ox <= 20 && ox >= -20 )
-        {
-            // bottom
-            position = 5;
-        }
+        n = _joystick_varintGet( &dec->buf[ pos ], dec->len - pos, i ? 2 : 5, &field[ i ] );
+
+        if ( n == 0 || n == 0xFF )
+            return n;
+
+        pos += n;
     }
-    
-    if ( ox < -20 && ox > -60 )
+
+    if ( dec->len <= pos )
+        return 0;
+
+    if ( _joystick_crc8( &dec->buf[ 1 ], pos - 1 ) != dec->buf[ pos ] )
+        return 0xFF;
+
+    record->timestamp = field[ 0 ];
+    // zig-zag back to signed
+    record->x = (int8_t)( ( field[ 1 ] >> 1 ) ^ -(int32_t)( field[ 1 ] & 1 ) );
+    record->y = (int8_t)( ( field[ 2 ] >> 1 ) ^ -(int32_t)( field[ 2 ] & 1 ) );
+    record->button = dec->buf[ 2 ] & _JOYSTICK_TELEMETRY_BUTTON;
+
+    return pos + 1;
+}
+
+#endif
+
+/* Vectoring mode CORDIC, rotates ( x, y ) onto the +X axis accumulating the angle */
+static void _joystick_cordic( int16_t x, int16_t y, uint16_t *magnitude, int16_t *angle )
+{
+    int32_t cx;
+    int32_t cy;
+    int32_t tx;
+    uint16_t acc;
+    uint8_t i;
+
+    cx = x;
+    cy = y;
+    acc = 0;
+
+    // bring the vector into the right half plane, CORDIC converges for +-99.9 degrees
+    if ( cx < 0 )
     {
-        if ( oy > 20 )
-        {
-            // top-right
-            position = 2;
-        }
-        else
-        {
-            // bottom-right
-            position = 4;
-        }
+        cx = -cx;
+        cy = -cy;
+        acc = 0x8000;
     }
-    
-    if ( ox < 60 && ox > 20 )
+
+    for ( i = 0; i < _JOYSTICK_CORDIC_STEPS; i++ )
     {
-        if ( oy < -20 )
+        tx = cx;
+
+        if ( cy > 0 )
         {
-            // top-left
-            position = 6;
+            cx += cy >> i;
+            cy -= tx >> i;
+            acc += _JOYSTICK_CORDIC_ATAN[ i ];
         }
         else
         {
-            // bottom-left
-            position = 8;
+            cx -= cy >> i;
+            cy += tx >> i;
+            acc -= _JOYSTICK_CORDIC_ATAN[ i ];
         }
     }
 
-    return position;
+    *magnitude = ( cx * _JOYSTICK_CORDIC_GAIN_Q15 ) >> 15;
+    *angle = (int16_t)acc;
 }
 
-/* Get state of interrupt pin function */
-uint8_t joystick_getInterrupt()
+/* Updates one half axis extent ( Q8 ) with a deflection ( Q8 ) and refreshes its gain when the integer part changes */
+static void _joystick_calibExtent( T_joystick_calib *cal, uint8_t idx, uint16_t deviation )
 {
-    return hal_gpio_intGet();
+    uint16_t ext;
+    uint16_t old;
+
+    old = cal->extent[ idx ];
+    ext = old;
+
+    if ( deviation > ext )
+        ext = deviation;
+    else if ( cal->decayShift )
+        ext -= ( ext - deviation ) >> cal->decayShift;
+
+    if ( ext < _JOYSTICK_CALIB_MIN_EXTENT )
+        ext = _JOYSTICK_CALIB_MIN_EXTENT;
+
+    cal->extent[ idx ] = ext;
+
+    if ( ( ext >> 8 ) != ( old >> 8 ) )
+        cal->gain[ idx ] = (uint16_t)( ( 127UL << 16 ) / ext );
 }
 
-/* Get state of Joystick button function */
-uint8_t joystick_pressButton()
+/* Moves center towards resting samples and extents towards deflected ones */
+static void _joystick_calibLearn( T_joystick_ctx *ctx, int8_t ox, int8_t oy )
 {
-    return hal_gpio_csGet();
+    T_joystick_calib *cal;
+    int32_t dx;
+    int32_t dy;
+    int32_t band;
+
+    cal = &ctx->calib;
+    dx = ( (int32_t)ox << 8 ) - cal->centerX;
+    dy = ( (int32_t)oy << 8 ) - cal->centerY;
+    band = (int32_t)ctx->lowThreshold << 8;
+
+    if ( dx < band && dx > -band && dy < band && dy > -band )
+    {
+        cal->centerX += dx >> _JOYSTICK_CALIB_CENTER_SHIFT;
+        cal->centerY += dy >> _JOYSTICK_CALIB_CENTER_SHIFT;
+        return;
+    }
+
+    if ( dx >= band )
+        _joystick_calibExtent( cal, 0, (uint16_t)dx );
+    else if ( dx <= -band )
+        _joystick_calibExtent( cal, 1, (uint16_t)-dx );
+
+    if ( dy >= band )
+        _joystick_calibExtent( cal, 2, (uint16_t)dy );
+    else if ( dy <= -band )
+        _joystick_calibExtent( cal, 3, (uint16_t)-dy );
 }
 
-/* General soft reset function */
-void joystick_softReset()
+/* Maps one axis through center offset and half axis gain, idx selects the positive half */
+static int8_t _joystick_calibApply( T_joystick_calib *cal, int8_t value, int16_t center, uint8_t idx )
 {
-    uint8_t buffer;
-    
-    buffer = joystick_readByte( _JOYSTICK_CONTROL1 );
-    buffer &= 0x01;
+    int32_t deviation;
+    int32_t scaled;
+
+    deviation = ( (int32_t)value << 8 ) - center;
+
+    if ( deviation < 0 )
+        idx++;
+
+    scaled = ( deviation * cal->gain[ idx ] ) >> 16;
 
-    joystick_writeByte( _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | buffer );
+    if ( scaled > 127 )
+        return 127;
+    if ( scaled < -128 )
+        return -128;
+
+    return (int8_t)scaled;
 }
 
-/* General hardware reset function*/
-void joystick_hardwareReset()
+/* Median of three values */
+static int8_t _joystick_median3( int8_t a, int8_t b, int8_t c )
 {
-    hal_gpio_rstSet( 0 );
-    Delay_10us();
-    hal_gpio_rstSet( 1 );
+    if ( a > b )
+    {
+        int8_t t = a;
+        a = b;
+        b = t;
+    }
+
+    if ( b > c )
+        b = c;
+
+    return a > b ? a : b;
+}
+
+/* Median of five values, Paeth's network of six compare-exchanges */
+static int8_t _joystick_median5( const int8_t *h )
+{
+    int8_t a;
+    int8_t b;
+    int8_t c;
+    int8_t d;
+    int8_t e;
+    int8_t t;
+
+    a = h[ 0 ];
+    b = h[ 1 ];
+    c = h[ 2 ];
+    d = h[ 3 ];
+    e = h[ 4 ];
+
+    if ( a > b ) { t = a; a = b; b = t; }
+    if ( c > d ) { t = c; c = d; d = t; }
+    if ( a > c ) { t = a; a = c; c = t; t = b; b = d; d = t; }
+
+    // a is the smallest of four and can not be the median, e takes its place
+    if ( e > b ) { t = e; e = b; b = t; }
+    if ( e > c ) { t = e; e = c; c = t; t = b; b = d; d = t; }
+
+    // median is the smaller of b and c
+    return b < c ? b : c;
+}
+
+/* Runs one axis through the selected filter */
+static int8_t _joystick_filterAxis( T_joystick_filter *flt, T_joystick_filterAxis *axis, int8_t value )
+{
+    int32_t delta;
+    int32_t alpha;
+    int32_t speed;
+    uint8_t i;
+
+    if ( !flt->primed )
+    {
+        axis->state = (int16_t)value << 8;
+        axis->speed = 0;
+
+        for ( i = 0; i < 5; i++ )
+            axis->history[ i ] = value;
+    }
+
+    axis->history[ flt->index ] = value;
+
+    if ( flt->type == _JOYSTICK_FILTER_MEDIAN3 )
+    {
+        return _joystick_median3( axis->history[ flt->index ],
+                                  axis->history[ ( flt->index + 4 ) % 5 ],
+                                  axis->history[ ( flt->index + 3 ) % 5 ] );
+    }
+
+    if ( flt->type == _JOYSTICK_FILTER_MEDIAN5 )
+        return _joystick_median5( axis->history );
+
+    delta = ( (int32_t)value << 8 ) - axis->state;
+
+    if ( flt->type == _JOYSTICK_FILTER_IIR )
+    {
+        axis->state += (int16_t)( delta >> flt->param1 );
+    }
+    else if ( flt->type == _JOYSTICK_FILTER_ADAPTIVE )
+    {
+        // speed follows | delta | over about 4 samples, coefficient grows linearly with it.
+        // | delta | reaches 255 << 8 on a full-scale swing, so speed saturates at the int16 limit
+        speed = axis->speed + ( ( ( delta < 0 ? -delta : delta ) - axis->speed ) >> 2 );
+
+        if ( speed > 32767 )
+            speed = 32767;
+
+        axis->speed = (int16_t)speed;
+
+        alpha = flt->param1 + ( speed >> 8 ) * flt->param2;
+
+        if ( alpha < flt->param1 )
+            alpha = flt->param1;
+        if ( alpha > 256 )
+            alpha = 256;
+
+        delta = axis->state + ( ( delta * alpha ) >> 8 );
+
+        // output stays within the int8 range in Q8
+        if ( delta < -128 * 256 )
+            delta = -128 * 256;
+        if ( delta > 127 * 256 )
+            delta = 127 * 256;
+
+        axis->state = (int16_t)delta;
+    }
+    else
+    {
+        return value;
+    }
+
+    return (int8_t)( ( axis->state + 128 ) >> 8 );
 }
 
 
+/* --------------------------------------------------------- PUBLIC FUNCTIONS */
+
+#ifdef   __JOYSTICK_DRV_SPI__
+
+void joystick_spiDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P spiObj)
+{
+    hal_spiMap( (T_HAL_P)spiObj );
+    hal_gpioMap( (T_HAL_P)gpioObj );
+
+    // ... power ON
+    // ... configure CHIP
+}
+
+#endif
+#ifdef   __JOYSTICK_DRV_I2C__
+
+void joystick_ctxI2cDriverInit(T_joystick_ctx *ctx, T_JOYSTICK_P gpioObj, T_JOYSTICK_P i2cObj, uint8_t slave)
+{
+    ctx->gpioObj = gpioObj;
+    ctx->i2cObj = i2cObj;
+    ctx->slaveAddress = slave;
+    ctx->shadowValid = 0;
+    ctx->i2cError = 0;
+    ctx->ringHead = 0;
+    ctx->ringTail = 0;
+    ctx->ringDropped = 0;
+    ctx->lowThreshold = _JOYSTICK_DEFAULT_LOW_THRESHOLD;
+    ctx->highThreshold = _JOYSTICK_DEFAULT_HIGH_THRESHOLD;
+    ctx->deadzone = 0;
+    ctx->hysteresis = _JOYSTICK_DEFAULT_HYSTERESIS;
+    ctx->zoneX = 2;
+    ctx->zoneY = 2;
+    ctx->inDeadzone = 0;
+    ctx->lastPosition = _JOYSTICK_POSITION_START;
+    ctx->timeSource = 0;
+    ctx->calib.mode = _JOYSTICK_CALIBRATION_OFF;
+    ctx->calib.decayShift = _JOYSTICK_CALIB_DEFAULT_DECAY;
+    joystick_ctxResetCalibration( ctx );
+    joystick_ctxSetFilter( ctx, _JOYSTICK_FILTER_NONE, 0, 0 );
+    joystick_ctxSetButtonTiming( ctx, _JOYSTICK_BUTTON_DEFAULT_TICK_US, _JOYSTICK_BUTTON_DEFAULT_DEBOUNCE,
+                                 _JOYSTICK_BUTTON_DEFAULT_LONG_PRESS, _JOYSTICK_BUTTON_DEFAULT_DOUBLE_CLICK );
+    ctx->rate.alignPeriod = 0;
+    joystick_ctxSetAdaptiveRate( ctx, _JOYSTICK_RATE_DEFAULT_PERIOD, _JOYSTICK_RATE_DEFAULT_PERIOD,
+                                 _JOYSTICK_RATE_DEFAULT_DELTA, _JOYSTICK_RATE_DEFAULT_IDLE );
+#ifdef __JOYSTICK_STATS__
+    joystick_ctxResetStats( ctx );
+#endif
+#ifdef __JOYSTICK_TELEMETRY__
+    joystick_ctxTelemetryReset( ctx );
+#endif
+
+    _activeCtx = 0;
+    _joystick_select( ctx );
+
+    hal_gpio_rstSet( 1 );
+}
+
+void joystick_i2cDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P i2cObj, uint8_t slave)
+{
+    joystick_ctxI2cDriverInit( &_joystick_defaultCtx, gpioObj, i2cObj, slave );
+}
+
+#endif
+#ifdef   __JOYSTICK_DRV_UART__
+
+void joystick_uartDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P uartObj)
+{
+    hal_uartMap( (T_HAL_P)uartObj );
+    hal_gpioMap( (T_HAL_P)gpioObj );
+
+    // ... power ON
+    // ... configure CHIP
+}
+
+#endif
+
+
+
+/* ----------------------------------------------------------- IMPLEMENTATION */
+
+
+/* Generic write 8-bit data to register function */
+void joystick_ctxWriteByte( T_joystick_ctx *ctx, uint8_t registerAddress, uint8_t dataWrite )
+{
+    uint8_t buffer[ 2 ];
+    uint8_t idx;
+  
+    buffer[ 0 ] = registerAddress;
+    buffer[ 1 ] = dataWrite;
+
+    _joystick_select( ctx );
+  
+    hal_i2cStart();
+
+    if ( hal_i2cWrite( ctx->slaveAddress, buffer, 2 , END_MODE_STOP ) )
+        ctx->i2cError = 1;
+
+    _JOYSTICK_STAT_ADD( ctx, transactions, 1 );
+    _JOYSTICK_STAT_ADD( ctx, starts, 1 );
+    _JOYSTICK_STAT_ADD( ctx, stops, 1 );
+    _JOYSTICK_STAT_ADD( ctx, bytes, 3 );
+
+    idx = _joystick_shadowIndex( registerAddress );
+
+    // Soft_rst reloads the reset value of every register, Control 1 included,
+    // so each write setting it leaves the whole shadow stale
+    if ( idx == 0 && ( dataWrite & _JOYSTICK_CONTROL1_SOFT_RST ) )
+    {
+        ctx->shadowValid = 0;
+    }
+    else if ( idx != 0xFF )
+    {
+        ctx->shadow[ idx ] = dataWrite;
+        ctx->shadowValid |= 1 << idx;
+    }
+}
+
+/* Generic read 8-bit data from register function */
+int8_t joystick_ctxReadByte( T_joystick_ctx *ctx, uint8_t registerAddress )
+{
+    uint8_t readReg[ 1 ];
+    int8_t result;
+
+    joystick_ctxReadData( ctx, registerAddress, readReg, 1 );
+    
+    result = readReg[ 0 ];
+
+    return result;
+}
+
+/* Generic sequential read of n bytes starting at register function */
+void joystick_ctxReadData( T_joystick_ctx *ctx, uint8_t registerAddress, uint8_t *dataBuf, uint8_t nBytes )
+{
+    uint8_t writeReg[ 1 ];
+    int status;
+
+    writeReg[ 0 ] = registerAddress;
+
+    _joystick_select( ctx );
+
+    hal_i2cStart();
+
+    // evaluate both, the read ends the transaction even when the write failed to queue
+    status = hal_i2cWrite( ctx->slaveAddress, writeReg, 1, END_MODE_RESTART );
+    status |= hal_i2cRead( ctx->slaveAddress, dataBuf, nBytes, END_MODE_STOP );
+
+    if ( status )
+        ctx->i2cError = 1;
+
+    _JOYSTICK_STAT_ADD( ctx, transactions, 1 );
+    _JOYSTICK_STAT_ADD( ctx, starts, 1 );
+    _JOYSTICK_STAT_ADD( ctx, restarts, 1 );
+    _JOYSTICK_STAT_ADD( ctx, stops, 1 );
+    _JOYSTICK_STAT_ADD( ctx, bytes, 3 + nBytes );
+}
+
+/* Burst read X and Y result registers function */
+void joystick_ctxReadXY( T_joystick_ctx *ctx, int8_t *ox, int8_t *oy )
+{
+    uint8_t readReg[ 2 ];
+
+    joystick_ctxReadData( ctx, _JOYSTICK_X, readReg, 2 );
+
+    *ox = readReg[ 0 ];
+    *oy = readReg[ 1 ];
+}
+
+/* Set default configuration function */
+void joystick_ctxSetDefaultConfiguration( T_joystick_ctx *ctx )
+{
+    uint8_t tempData;
+
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL2, _JOYSTICK_CONTROL2_TEST_CMD );
+  
+    joystick_ctxWriteByte( ctx, _JOYSTICK_AGC, _JOYSTICK_AGC_MAX_SENSITIVITY_CMD );
+  
+    joystick_ctxWriteByte( ctx, _JOYSTICK_T_CTRL, _JOYSTICK_T_CTRL_SCALING_90_8_CMD );
+  
+    tempData = _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 );
+    tempData &= 0x01;
+    
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | tempData );
+}
+
+/* Check sensor ID code function */
+uint8_t joystick_ctxCheckIdCode( T_joystick_ctx *ctx )
+{
+    return ( joystick_ctxReadByte( ctx, _JOYSTICK_ID_CODE ) == _JOYSTICK_ID_CODE ) ? 1 : 0;
+}
+
+/* Check sensor ID version function */
+uint8_t joystick_ctxCheckIdVersion( T_joystick_ctx *ctx )
+{
+    return ( joystick_ctxReadByte( ctx, _JOYSTICK_ID_VERSION ) == _JOYSTICK_ID_VERSION ) ? 1 : 0;
+}
+
+/* Set Low Power Mode function */
+void joystick_ctxSetLowPowerMode( T_joystick_ctx *ctx, uint8_t timings )
+{
+    uint8_t tempData;
+    
+    timings %= 8;
+
+    tempData = _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 );
+    tempData &= 0x0F;
+    tempData |= timings << 4;
+
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL1, tempData );
+
+    if ( ctx->rate.alignPeriod )
+        ctx->rate.alignPeriod = _JOYSTICK_LOW_POWER_PERIOD[ timings ];
+}
+
+/* Set scaling factor function */
+void joystick_ctxSetScalingFactor( T_joystick_ctx *ctx, uint8_t scalingFactor )
+{
+    if ( scalingFactor < 32 )
+        joystick_ctxWriteByte( ctx, _JOYSTICK_T_CTRL, scalingFactor );
+    else
+        joystick_ctxWriteByte( ctx, _JOYSTICK_T_CTRL, _JOYSTICK_T_CTRL_SCALING_100_CMD );
+}
+
+/* Set interrupt disabled function */
+void joystick_ctxDisabledInterrupt( T_joystick_ctx *ctx )
+{
+    uint8_t tempData;
+
+    // without Soft_rst the rest of Control 1 and the shadow stay valid
+    tempData = _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 );
+    tempData &= ~( _JOYSTICK_CONTROL1_SOFT_RST | _JOYSTICK_CONTROL1_INT_EN );
+    tempData |= _JOYSTICK_CONTROL1_BIT3;
+
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL1, tempData );
+}
+
+/* Set interrupt enabled function */
+void joystick_ctxEnabledInterrupt( T_joystick_ctx *ctx )
+{
+    uint8_t tempData;
+
+    tempData = _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 );
+    tempData &= ~_JOYSTICK_CONTROL1_SOFT_RST;
+    tempData |= _JOYSTICK_CONTROL1_BIT3 | _JOYSTICK_CONTROL1_INT_EN;
+
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL1, tempData );
+}
+
+/* Invert the channel voltage function */
+void joystick_ctxInvertSpinning( T_joystick_ctx *ctx )
+{
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL2, _JOYSTICK_INVERT_SPINING_CMD );
+}
+
+/* Set direction thresholds function */
+void joystick_ctxSetThresholds( T_joystick_ctx *ctx, uint8_t lowThreshold, uint8_t highThreshold )
+{
+    if ( lowThreshold < 1 )
+        lowThreshold = 1;
+    if ( highThreshold > 127 )
+        highThreshold = 127;
+    if ( highThreshold <= lowThreshold )
+        highThreshold = lowThreshold + 1;
+
+    ctx->lowThreshold = lowThreshold;
+    ctx->highThreshold = highThreshold;
+}
+
+/* Classify X and Y results into position function */
+uint8_t joystick_ctxClassify( T_joystick_ctx *ctx, int8_t ox, int8_t oy )
+{
+    uint8_t zx;
+    uint8_t zy;
+
+    zx = _joystick_zone( ox, ctx->lowThreshold, ctx->highThreshold );
+    zy = _joystick_zone( oy, ctx->lowThreshold, ctx->highThreshold );
+
+    return _JOYSTICK_ZONE_TABLE[ zy ][ zx ];
+}
+
+/* Set deadzone and hysteresis function */
+void joystick_ctxSetDeadzone( T_joystick_ctx *ctx, uint8_t radius, uint8_t hysteresis )
+{
+    ctx->deadzone = radius;
+    ctx->hysteresis = hysteresis;
+}
+
+/* Classify with deadzone and hysteresis function */
+uint8_t joystick_ctxClassifyStable( T_joystick_ctx *ctx, int8_t ox, int8_t oy )
+{
+    uint32_t radius2;
+    uint32_t limit;
+
+    if ( ctx->deadzone )
+    {
+        radius2 = (uint32_t)( (int16_t)ox * ox ) + (uint32_t)( (int16_t)oy * oy );
+        limit = ctx->deadzone;
+
+        if ( ctx->inDeadzone )
+            limit += ctx->hysteresis;
+
+        if ( radius2 < limit * limit )
+        {
+            ctx->inDeadzone = 1;
+            ctx->zoneX = 2;
+            ctx->zoneY = 2;
+
+            return _JOYSTICK_POSITION_START;
+        }
+
+        ctx->inDeadzone = 0;
+    }
+
+    ctx->zoneX = _joystick_zoneHysteresis( ox, ctx->zoneX, ctx->lowThreshold, ctx->highThreshold, ctx->hysteresis );
+    ctx->zoneY = _joystick_zoneHysteresis( oy, ctx->zoneY, ctx->lowThreshold, ctx->highThreshold, ctx->hysteresis );
+
+    return _JOYSTICK_ZONE_TABLE[ ctx->zoneY ][ ctx->zoneX ];
+}
+
+/* Feed sample to direction tracker function */
+uint8_t joystick_ctxUpdatePosition( T_joystick_ctx *ctx, int8_t ox, int8_t oy, uint8_t *position )
+{
+    uint8_t current;
+
+    current = joystick_ctxClassifyStable( ctx, ox, oy );
+
+    if ( current == ctx->lastPosition )
+        return 0;
+
+    ctx->lastPosition = current;
+    *position = current;
+
+    return 1;
+}
+
+/* Get position change event function */
+uint8_t joystick_ctxGetPositionEvent( T_joystick_ctx *ctx, uint8_t *position )
+{
+    int8_t ox;
+    int8_t oy;
+
+    joystick_ctxReadXY( ctx, &ox, &oy );
+    joystick_ctxProcess( ctx, &ox, &oy );
+
+    return joystick_ctxUpdatePosition( ctx, ox, oy, position );
+}
+
+/* Get joystick position function */
+uint8_t joystick_ctxGetPosition( T_joystick_ctx *ctx )
+{
+    int8_t ox;
+    int8_t oy;
+
+    joystick_ctxReadXY( ctx, &ox, &oy );
+    joystick_ctxProcess( ctx, &ox, &oy );
+
+    return joystick_ctxClassify( ctx, ox, oy );
+}
+
+/* Get state of interrupt pin function */
+uint8_t joystick_ctxGetInterrupt( T_joystick_ctx *ctx )
+{
+    _joystick_select( ctx );
+
+    return hal_gpio_intGet();
+}
+
+/* Get state of Joystick button function */
+uint8_t joystick_ctxPressButton( T_joystick_ctx *ctx )
+{
+    _joystick_select( ctx );
+
+    return hal_gpio_csGet();
+}
+
+/* General soft reset function */
+void joystick_ctxSoftReset( T_joystick_ctx *ctx )
+{
+    uint8_t buffer;
+    
+    buffer = _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 );
+    buffer &= 0x01;
+
+    // the Soft_rst write invalidates the shadow
+    joystick_ctxWriteByte( ctx, _JOYSTICK_CONTROL1, _JOYSTICK_CONTROL1_RESET_CMD | buffer );
+}
+
+/* General hardware reset function*/
+void joystick_ctxHardwareReset( T_joystick_ctx *ctx )
+{
+    _joystick_select( ctx );
+
+    hal_gpio_rstSet( 0 );
+    Delay_10us();
+    _JOYSTICK_STAT_ADD( ctx, delayUs, 10 );
+    hal_gpio_rstSet( 1 );
+
+    joystick_ctxInvalidateShadow( ctx );
+}
+
+/* Invalidate configuration register shadow function */
+void joystick_ctxInvalidateShadow( T_joystick_ctx *ctx )
+{
+    ctx->shadowValid = 0;
+}
+
+/* Get I2C error function */
+uint8_t joystick_ctxGetI2cError( T_joystick_ctx *ctx )
+{
+    uint8_t error;
+
+    error = ctx->i2cError;
+    ctx->i2cError = 0;
+
+    return error;
+}
+
+/* Start event mode function */
+void joystick_ctxStartEventMode( T_joystick_ctx *ctx )
+{
+    ctx->ringTail = ctx->ringHead;
+    ctx->ringDropped = 0;
+
+    joystick_ctxEnabledInterrupt( ctx );
+}
+
+/* Event mode interrupt handler function */
+void joystick_ctxIsrHandler( T_joystick_ctx *ctx )
+{
+    uint8_t head;
+    T_joystick_sample *slot;
+    T_joystick_ctx *previous;
+    int8_t ox;
+    int8_t oy;
+
+    // the interrupted foreground may be using another instance, hand its mapping back on exit
+    previous = _activeCtx;
+    head = ctx->ringHead;
+
+    if ( (uint8_t)( head - ctx->ringTail ) >= _JOYSTICK_RING_SIZE )
+    {
+        // still release INT so the next measurement is signalled
+        joystick_ctxReadXY( ctx, &ox, &oy );
+        ctx->ringDropped++;
+        _joystick_restore( previous );
+        return;
+    }
+
+    slot = &ctx->ring[ head & _JOYSTICK_RING_MASK ];
+
+    joystick_ctxReadXY( ctx, &slot->x, &slot->y );
+    slot->button = joystick_ctxPressButton( ctx );
+
+    _JOYSTICK_BARRIER();
+    ctx->ringHead = head + 1;
+
+    _joystick_restore( previous );
+}
+
+/* Pop sample from event ring function */
+uint8_t joystick_ctxPopSample( T_joystick_ctx *ctx, T_joystick_sample *sample )
+{
+    uint8_t tail;
+
+    tail = ctx->ringTail;
+
+    if ( tail == ctx->ringHead )
+        return 0;
+
+    _JOYSTICK_BARRIER();
+    *sample = ctx->ring[ tail & _JOYSTICK_RING_MASK ];
+    _JOYSTICK_BARRIER();
+
+    ctx->ringTail = tail + 1;
+
+    return 1;
+}
+
+/* Get number of dropped samples function */
+uint8_t joystick_ctxGetDroppedSamples( T_joystick_ctx *ctx )
+{
+    return ctx->ringDropped;
+}
+
+/* Compute analog vector function */
+void joystick_ctxComputeVector( T_joystick_ctx *ctx, int8_t ox, int8_t oy, T_joystick_vector *vector )
+{
+    (void)ctx;
+
+    vector->x = (int16_t)ox << 8;
+    vector->y = (int16_t)oy << 8;
+
+    _joystick_cordic( vector->x, vector->y, &vector->magnitude, &vector->angle );
+}
+
+/* Get analog vector function */
+void joystick_ctxGetVector( T_joystick_ctx *ctx, T_joystick_vector *vector )
+{
+    int8_t ox;
+    int8_t oy;
+
+    joystick_ctxReadXY( ctx, &ox, &oy );
+    joystick_ctxProcess( ctx, &ox, &oy );
+
+    joystick_ctxComputeVector( ctx, ox, oy, vector );
+}
+
+/* Process raw sample function */
+void joystick_ctxProcess( T_joystick_ctx *ctx, int8_t *ox, int8_t *oy )
+{
+    T_joystick_calib *cal;
+
+    cal = &ctx->calib;
+
+    if ( cal->mode == _JOYSTICK_CALIBRATION_LEARN )
+        _joystick_calibLearn( ctx, *ox, *oy );
+
+    if ( cal->mode != _JOYSTICK_CALIBRATION_OFF )
+    {
+        *ox = _joystick_calibApply( cal, *ox, cal->centerX, 0 );
+        *oy = _joystick_calibApply( cal, *oy, cal->centerY, 2 );
+    }
+
+    if ( ctx->filter.type != _JOYSTICK_FILTER_NONE )
+    {
+        *ox = _joystick_filterAxis( &ctx->filter, &ctx->filter.axis[ 0 ], *ox );
+        *oy = _joystick_filterAxis( &ctx->filter, &ctx->filter.axis[ 1 ], *oy );
+
+        ctx->filter.primed = 1;
+        ctx->filter.index = ( ctx->filter.index + 1 ) % 5;
+    }
+}
+
+/* Set filter function */
+void joystick_ctxSetFilter( T_joystick_ctx *ctx, uint8_t type, uint8_t param1, uint8_t param2 )
+{
+    if ( type == _JOYSTICK_FILTER_IIR )
+    {
+        if ( !param1 )
+            param1 = _JOYSTICK_FILTER_DEFAULT_SHIFT;
+        if ( param1 > 7 )
+            param1 = 7;
+    }
+
+    if ( type == _JOYSTICK_FILTER_ADAPTIVE )
+    {
+        if ( !param1 )
+            param1 = _JOYSTICK_FILTER_DEFAULT_MIN;
+        if ( !param2 )
+            param2 = _JOYSTICK_FILTER_DEFAULT_BETA;
+    }
+
+    ctx->filter.type = type;
+    ctx->filter.param1 = param1;
+    ctx->filter.param2 = param2;
+    ctx->filter.index = 0;
+    ctx->filter.primed = 0;
+}
+
+/* Set calibration mode function */
+void joystick_ctxSetCalibrationMode( T_joystick_ctx *ctx, uint8_t mode )
+{
+    ctx->calib.mode = mode;
+}
+
+/* Set calibration extent decay function */
+void joystick_ctxSetCalibrationDecay( T_joystick_ctx *ctx, uint8_t decayShift )
+{
+    ctx->calib.decayShift = decayShift;
+}
+
+/* Reset calibration function */
+void joystick_ctxResetCalibration( T_joystick_ctx *ctx )
+{
+    uint8_t i;
+
+    ctx->calib.centerX = 0;
+    ctx->calib.centerY = 0;
+
+    for ( i = 0; i < 4; i++ )
+    {
+        ctx->calib.extent[ i ] = 127 << 8;
+        ctx->calib.gain[ i ] = 256;
+    }
+}
+
+/* Get calibration blob function */
+void joystick_ctxGetCalibration( T_joystick_ctx *ctx, uint8_t *blob )
+{
+    uint8_t sum;
+    uint8_t i;
+
+    blob[ 0 ] = _JOYSTICK_CALIB_VERSION;
+    blob[ 1 ] = (uint8_t)( ( ctx->calib.centerX + 128 ) >> 8 );
+    blob[ 2 ] = (uint8_t)( ( ctx->calib.centerY + 128 ) >> 8 );
+
+    for ( i = 0; i < 4; i++ )
+        blob[ 3 + i ] = ctx->calib.extent[ i ] >> 8;
+
+    sum = 0;
+    for ( i = 0; i < _JOYSTICK_CALIBRATION_SIZE - 1; i++ )
+        sum += blob[ i ];
+
+    blob[ _JOYSTICK_CALIBRATION_SIZE - 1 ] = ~sum;
+}
+
+/* Set calibration blob function */
+uint8_t joystick_ctxSetCalibration( T_joystick_ctx *ctx, const uint8_t *blob )
+{
+    uint8_t sum;
+    uint8_t i;
+
+    sum = 0;
+    for ( i = 0; i < _JOYSTICK_CALIBRATION_SIZE; i++ )
+        sum += blob[ i ];
+
+    if ( blob[ 0 ] != _JOYSTICK_CALIB_VERSION || sum != 0xFF )
+        return 0;
+
+    ctx->calib.centerX = (int16_t)(int8_t)blob[ 1 ] << 8;
+    ctx->calib.centerY = (int16_t)(int8_t)blob[ 2 ] << 8;
+
+    for ( i = 0; i < 4; i++ )
+    {
+        ctx->calib.extent[ i ] = (uint16_t)blob[ 3 + i ] << 8;
+
+        if ( ctx->calib.extent[ i ] < _JOYSTICK_CALIB_MIN_EXTENT )
+            ctx->calib.extent[ i ] = _JOYSTICK_CALIB_MIN_EXTENT;
+
+        ctx->calib.gain[ i ] = (uint16_t)( ( 127UL << 16 ) / ctx->calib.extent[ i ] );
+    }
+
+    return 1;
+}
+
+/* Set time source function */
+void joystick_ctxSetTimeSource( T_joystick_ctx *ctx, T_joystick_timeFp timeSource )
+{
+    ctx->timeSource = timeSource;
+}
+
+/* Batched sampling function */
+void joystick_ctxSampleBatch( T_joystick_ctx *ctx, T_joystick_record *buf, uint8_t n, uint32_t periodUs )
+{
+    uint32_t start;
+    uint32_t deadline;
+    uint32_t wait;
+    uint8_t i;
+
+    start = 0;
+
+    if ( ctx->timeSource )
+        start = ctx->timeSource();
+
+    for ( i = 0; i < n; i++ )
+    {
+        if ( i )
+        {
+            if ( ctx->timeSource )
+            {
+                deadline = start + i * periodUs;
+                while ( (int32_t)( ctx->timeSource() - deadline ) < 0 );
+            }
+            else
+            {
+                for ( wait = periodUs / 10; wait; wait-- )
+                    Delay_10us();
+                _JOYSTICK_STAT_ADD( ctx, delayUs, periodUs / 10 * 10 );
+            }
+        }
+
+        joystick_ctxReadXY( ctx, &buf[ i ].x, &buf[ i ].y );
+        buf[ i ].button = joystick_ctxPressButton( ctx );
+
+        if ( ctx->timeSource )
+            buf[ i ].timestamp = ctx->timeSource() - start;
+        else
+            buf[ i ].timestamp = i * periodUs;
+    }
+}
+
+/* Set button debounce timing function */
+void joystick_ctxSetButtonTiming( T_joystick_ctx *ctx, uint16_t tickUs, uint8_t debounceTicks, uint16_t longPressTicks, uint16_t doubleClickTicks )
+{
+    T_joystick_button *btn;
+
+    btn = &ctx->button;
+
+    if ( debounceTicks == 0 )
+        debounceTicks = 1;
+
+    btn->tickUs = tickUs;
+    btn->debounceTicks = debounceTicks;
+    btn->longPressTicks = longPressTicks;
+    btn->doubleClickTicks = doubleClickTicks;
+
+    btn->integrator = 0;
+    btn->state = 0;
+    btn->timer = 0;
+    btn->longSent = 0;
+    btn->clickPending = 0;
+    btn->ticks = 0;
+    btn->queueHead = 0;
+    btn->queueTail = 0;
+    btn->queueDropped = 0;
+}
+
+/* Button tick function */
+void joystick_ctxButtonTick( T_joystick_ctx *ctx )
+{
+    T_joystick_button *btn;
+    T_joystick_ctx *previous;
+    uint8_t level;
+
+    btn = &ctx->button;
+    btn->ticks++;
+
+    // runs from a timer interrupt, the foreground instance keeps its pins
+    previous = _activeCtx;
+    level = joystick_ctxPressButton( ctx );
+    _joystick_restore( previous );
+
+    if ( level )
+    {
+        if ( btn->integrator < btn->debounceTicks )
+            btn->integrator++;
+    }
+    else if ( btn->integrator )
+    {
+        btn->integrator--;
+    }
+
+    if ( btn->timer != 0xFFFF )
+        btn->timer++;
+
+    if ( !btn->state && btn->integrator == btn->debounceTicks )
+    {
+        btn->state = 1;
+        _joystick_buttonEmit( ctx, _JOYSTICK_BUTTON_PRESS );
+
+        if ( btn->clickPending && btn->timer <= btn->doubleClickTicks )
+        {
+            _joystick_buttonEmit( ctx, _JOYSTICK_BUTTON_DOUBLE_CLICK );
+            // the second click of a pair does not start a new one
+            btn->clickPending = 2;
+        }
+        else
+        {
+            btn->clickPending = 0;
+        }
+
+        btn->timer = 0;
+        btn->longSent = 0;
+    }
+    else if ( btn->state && btn->integrator == 0 )
+    {
+        btn->state = 0;
+        _joystick_buttonEmit( ctx, _JOYSTICK_BUTTON_RELEASE );
+
+        btn->clickPending = ( btn->doubleClickTicks && !btn->longSent && btn->clickPending != 2 );
+        btn->timer = 0;
+    }
+    else if ( btn->state && !btn->longSent && btn->longPressTicks && btn->timer >= btn->longPressTicks )
+    {
+        btn->longSent = 1;
+        _joystick_buttonEmit( ctx, _JOYSTICK_BUTTON_LONG_PRESS );
+    }
+
+    if ( btn->clickPending && !btn->state && btn->timer > btn->doubleClickTicks )
+        btn->clickPending = 0;
+}
+
+/* Button engine busy function */
+uint8_t joystick_ctxButtonBusy( T_joystick_ctx *ctx )
+{
+    T_joystick_button *btn;
+
+    btn = &ctx->button;
+
+    if ( btn->integrator != 0 && btn->integrator != btn->debounceTicks )
+        return 1;
+
+    if ( btn->state )
+        return !btn->longSent && btn->longPressTicks;
+
+    return btn->clickPending;
+}
+
+/* Get debounced button state function */
+uint8_t joystick_ctxGetButtonState( T_joystick_ctx *ctx )
+{
+    return ctx->button.state;
+}
+
+/* Pop button event function */
+uint8_t joystick_ctxPopButtonEvent( T_joystick_ctx *ctx, T_joystick_buttonEvent *event )
+{
+    T_joystick_button *btn;
+    uint8_t tail;
+
+    btn = &ctx->button;
+    tail = btn->queueTail;
+
+    if ( tail == btn->queueHead )
+        return 0;
+
+    _JOYSTICK_BARRIER();
+    *event = btn->queue[ tail & _JOYSTICK_BUTTON_QUEUE_MASK ];
+    _JOYSTICK_BARRIER();
+
+    btn->queueTail = tail + 1;
+
+    return 1;
+}
+
+/* Get number of dropped button events function */
+uint8_t joystick_ctxGetDroppedButtonEvents( T_joystick_ctx *ctx )
+{
+    return ctx->button.queueDropped;
+}
+
+/* Set adaptive polling rate function */
+void joystick_ctxSetAdaptiveRate( T_joystick_ctx *ctx, uint16_t minPeriod, uint16_t maxPeriod, uint8_t deltaThreshold, uint8_t idleSamples )
+{
+    T_joystick_rate *rate;
+
+    rate = &ctx->rate;
+
+    if ( minPeriod == 0 )
+        minPeriod = 1;
+
+    if ( maxPeriod < minPeriod )
+        maxPeriod = minPeriod;
+
+    if ( idleSamples == 0 )
+        idleSamples = 1;
+
+    rate->minPeriod = minPeriod;
+    rate->maxPeriod = maxPeriod;
+    rate->period = minPeriod;
+    rate->deltaThreshold = deltaThreshold;
+    rate->idleSamples = idleSamples;
+    rate->idleCount = 0;
+    rate->primed = 0;
+}
+
+/* Set rate alignment to the low power timebase function */
+void joystick_ctxSetRateAlignment( T_joystick_ctx *ctx, uint8_t enable )
+{
+    if ( enable )
+        ctx->rate.alignPeriod = _JOYSTICK_LOW_POWER_PERIOD[ ( _joystick_readConfig( ctx, _JOYSTICK_CONTROL1 ) >> 4 ) & 0x07 ];
+    else
+        ctx->rate.alignPeriod = 0;
+}
+
+/* Update adaptive polling rate function */
+uint16_t joystick_ctxUpdateRate( T_joystick_ctx *ctx, int8_t ox, int8_t oy )
+{
+    T_joystick_rate *rate;
+    int16_t dx;
+    int16_t dy;
+    int16_t lo;
+    uint16_t period;
+
+    rate = &ctx->rate;
+
+    dx = (int16_t)ox - rate->lastX;
+    dy = (int16_t)oy - rate->lastY;
+    rate->lastX = ox;
+    rate->lastY = oy;
+
+    if ( dx < 0 )
+        dx = -dx;
+    if ( dy < 0 )
+        dy = -dy;
+
+    lo = ctx->lowThreshold;
+
+    // the first sample has no delta, it only counts as rest when centered
+    if ( rate->primed && ( dx > rate->deltaThreshold || dy > rate->deltaThreshold ) )
+    {
+        rate->period = rate->minPeriod;
+        rate->idleCount = 0;
+    }
+    else if ( ox > -lo && ox < lo && oy > -lo && oy < lo )
+    {
+        if ( ++rate->idleCount >= rate->idleSamples )
+        {
+            rate->idleCount = 0;
+            rate->period = ( rate->period > rate->maxPeriod / 2 ) ? rate->maxPeriod : rate->period * 2;
+        }
+    }
+    else
+    {
+        rate->idleCount = 0;
+    }
+
+    rate->primed = 1;
+    period = rate->period;
+
+    // round up to whole timebase periods, a faster read would see the same result
+    if ( rate->alignPeriod )
+        period = ( period + rate->alignPeriod - 1 ) / rate->alignPeriod * rate->alignPeriod;
+
+    return period;
+}
+
+/* Task runner initialization function */
+void joystick_taskInit()
+{
+    _joystick_taskCount = 0;
+    _joystick_taskTicks = 0;
+    _joystick_taskLast = 0;
+}
+
+/* Add task function */
+uint8_t joystick_taskAdd( T_joystick_taskFp task, uint16_t period, uint16_t offset )
+{
+    T_joystick_task *slot;
+
+    if ( _joystick_taskCount >= _JOYSTICK_TASK_MAX )
+        return 0;
+
+    if ( period == 0 )
+        period = 1;
+
+    slot = &_joystick_tasks[ _joystick_taskCount ];
+    slot->task = task;
+    slot->period = period;
+    slot->remaining = offset + 1;
+
+    _joystick_taskCount++;
+
+    return 1;
+}
+
+/* Change task period function */
+uint8_t joystick_taskSetPeriod( T_joystick_taskFp task, uint16_t period )
+{
+    T_joystick_task *slot;
+    uint8_t i;
+
+    if ( period == 0 )
+        period = 1;
+
+    for ( i = 0; i < _joystick_taskCount; i++ )
+    {
+        slot = &_joystick_tasks[ i ];
+
+        if ( slot->task != task )
+            continue;
+
+        // remaining never exceeds the old period, so this stays within the new one
+        if ( period > slot->period )
+            slot->remaining += period - slot->period;
+        else if ( slot->remaining > period )
+            slot->remaining = period;
+
+        slot->period = period;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Task runner tick function */
+void joystick_taskTick()
+{
+    _joystick_taskTicks++;
+}
+
+/* Run due tasks function */
+uint8_t joystick_taskRun()
+{
+    T_joystick_task *slot;
+    uint8_t now;
+    uint8_t elapsed;
+    uint8_t ran;
+    uint8_t i;
+    uint16_t late;
+
+    now = _joystick_taskTicks;
+    elapsed = now - _joystick_taskLast;
+    _joystick_taskLast = now;
+
+    ran = 0;
+
+    for ( i = 0; i < _joystick_taskCount; i++ )
+    {
+        slot = &_joystick_tasks[ i ];
+
+        if ( slot->remaining > elapsed )
+        {
+            slot->remaining -= elapsed;
+            continue;
+        }
+
+        late = elapsed - slot->remaining;
+        slot->remaining = ( late < slot->period ) ? slot->period - late : slot->period - late % slot->period;
+
+        slot->task();
+        ran++;
+    }
+
+    return ran;
+}
+
+/* Event logger initialization function */
+void joystick_logInit( T_joystick_logKickFp kick )
+{
+    _joystick_logKick = kick;
+    _joystick_logHead = 0;
+    _joystick_logTail = 0;
+    _joystick_logBusy = 0;
+    _joystick_logDropped = 0;
+    _joystick_logTxActive = 0;
+}
+
+/* Log event function */
+uint8_t joystick_logEvent( uint8_t type, uint8_t value )
+{
+    T_joystick_logRecord *slot;
+    uint8_t head;
+
+    head = _joystick_logHead;
+
+    if ( (uint8_t)( head - _joystick_logTail ) >= _JOYSTICK_LOG_SIZE )
+    {
+        if ( _joystick_logDropped != 0xFFFF )
+            _joystick_logDropped++;
+
+        return 0;
+    }
+
+    slot = &_joystick_logRing[ head & _JOYSTICK_LOG_MASK ];
+    slot->type = type;
+    slot->value = value;
+
+    _JOYSTICK_BARRIER();
+    _joystick_logHead = head + 1;
+    _JOYSTICK_BARRIER();
+
+    if ( !_joystick_logBusy )
+    {
+        _joystick_logBusy = 1;
+
+        if ( _joystick_logKick )
+            _joystick_logKick();
+    }
+
+    return 1;
+}
+
+/* Get next log byte function */
+uint8_t joystick_logTxByte( uint8_t *byte )
+{
+    uint8_t tail;
+    char c;
+
+    if ( !_joystick_logTxActive )
+    {
+        tail = _joystick_logTail;
+
+        if ( tail == _joystick_logHead )
+        {
+            // recheck after going idle, a record queued meanwhile did not kick
+            _joystick_logBusy = 0;
+            _JOYSTICK_BARRIER();
+
+            if ( tail == _joystick_logHead )
+                return 0;
+
+            _joystick_logBusy = 1;
+        }
+
+        _JOYSTICK_BARRIER();
+        _joystick_logTx = _joystick_logRing[ tail & _JOYSTICK_LOG_MASK ];
+        _JOYSTICK_BARRIER();
+        _joystick_logTail = tail + 1;
+
+        _joystick_logTxIndex = 0;
+        _joystick_logTxActive = 1;
+    }
+
+    if ( _joystick_logTxIndex == _JOYSTICK_LOG_LF )
+    {
+        _joystick_logTxActive = 0;
+        *byte = '\n';
+
+        return 1;
+    }
+
+    c = _joystick_logChar( &_joystick_logTx, _joystick_logTxIndex );
+
+    if ( c == 0 )
+    {
+        _joystick_logTxIndex = _JOYSTICK_LOG_LF;
+        *byte = '\r';
+
+        return 1;
+    }
+
+    _joystick_logTxIndex++;
+    *byte = c;
+
+    return 1;
+}
+
+/* Get number of dropped log events function */
+uint16_t joystick_logGetDropped()
+{
+    return _joystick_logDropped;
+}
+
+#ifdef __JOYSTICK_STATS__
+
+/* Get I2C bus cost counters function */
+void joystick_ctxGetStats( T_joystick_ctx *ctx, T_joystick_stats *stats )
+{
+    *stats = ctx->stats;
+}
+
+/* Reset I2C bus cost counters function */
+void joystick_ctxResetStats( T_joystick_ctx *ctx )
+{
+    ctx->stats.transactions = 0;
+    ctx->stats.bytes = 0;
+    ctx->stats.starts = 0;
+    ctx->stats.restarts = 0;
+    ctx->stats.stops = 0;
+    ctx->stats.delayUs = 0;
+}
+
+#endif
+
+#ifdef __JOYSTICK_TELEMETRY__
+
+/* Reset telemetry encoder function */
+void joystick_ctxTelemetryReset( T_joystick_ctx *ctx )
+{
+    ctx->telemetry.seq = 0;
+    ctx->telemetry.sinceKey = 0;
+}
+
+/* Encode telemetry frame function */
+uint8_t joystick_ctxTelemetryEncode( T_joystick_ctx *ctx, T_joystick_record *record, uint8_t *frame )
+{
+    T_joystick_telemetry *tel;
+    uint8_t flags;
+    uint8_t len;
+    int16_t dx;
+    int16_t dy;
+
+    tel = &ctx->telemetry;
+
+    flags = record->button ? _JOYSTICK_TELEMETRY_BUTTON : 0;
+
+    if ( tel->sinceKey == 0 )
+    {
+        flags |= _JOYSTICK_TELEMETRY_KEY;
+        tel->timestamp = 0;
+        tel->x = 0;
+        tel->y = 0;
+    }
+
+    dx = (int16_t)record->x - tel->x;
+    dy = (int16_t)record->y - tel->y;
+
+    frame[ 0 ] = _JOYSTICK_TELEMETRY_SYNC;
+    frame[ 1 ] = tel->seq;
+    frame[ 2 ] = flags;
+    len = 3;
+    len += _joystick_varintPut( &frame[ len ], record->timestamp - tel->timestamp );
+    len += _joystick_varintPut( &frame[ len ], (uint16_t)( ( (uint16_t)dx << 1 ) ^ (uint16_t)( dx >> 15 ) ) );
+    len += _joystick_varintPut( &frame[ len ], (uint16_t)( ( (uint16_t)dy << 1 ) ^ (uint16_t)( dy >> 15 ) ) );
+    frame[ len ] = _joystick_crc8( &frame[ 1 ], len - 1 );
+    len++;
+
+    tel->seq++;
+    tel->timestamp = record->timestamp;
+    tel->x = record->x;
+    tel->y = record->y;
+
+    if ( ++tel->sinceKey >= _JOYSTICK_TELEMETRY_KEY_INTERVAL )
+        tel->sinceKey = 0;
+
+    return len;
+}
+
+/* Telemetry decoder initialization function */
+void joystick_telemetryDecoderInit( T_joystick_telemetryDecoder *dec )
+{
+    dec->len = 0;
+    dec->synced = 0;
+    dec->seq = 0;
+    dec->frames = 0;
+    dec->crcErrors = 0;
+    dec->lost = 0;
+}
+
+/* Decode telemetry byte function */
+uint8_t joystick_telemetryDecode( T_joystick_telemetryDecoder *dec, uint8_t byte, T_joystick_record *record )
+{
+    T_joystick_record delta;
+    uint8_t n;
+    uint8_t i;
+    uint8_t gap;
+
+    if ( dec->len == 0 && byte != _JOYSTICK_TELEMETRY_SYNC )
+        return 0;
+
+    dec->buf[ dec->len++ ] = byte;
+
+    for ( ;; )
+    {
+        n = _joystick_telemetryParse( dec, &delta );
+
+        if ( n == 0 )
+            return 0;
+
+        if ( n != 0xFF )
+            break;
+
+        // bad frame, restart at the next sync byte in the buffer
+        dec->crcErrors++;
+
+        for ( i = 1; i < dec->len && dec->buf[ i ] != _JOYSTICK_TELEMETRY_SYNC; i++ );
+
+        dec->len -= i;
+
+        for ( n = 0; n < dec->len; n++ )
+            dec->buf[ n ] = dec->buf[ n + i ];
+
+        if ( dec->len == 0 )
+            return 0;
+    }
+
+    gap = dec->buf[ 1 ] - dec->seq;
+    dec->seq = dec->buf[ 1 ] + 1;
+
+    if ( dec->synced && gap )
+    {
+        dec->lost += gap;
+        dec->synced = 0;
+    }
+
+    if ( dec->buf[ 2 ] & _JOYSTICK_TELEMETRY_KEY )
+    {
+        dec->synced = 1;
+        dec->timestamp = 0;
+        dec->x = 0;
+        dec->y = 0;
+    }
+
+    // consume the frame
+    dec->len -= n;
+
+    for ( i = 0; i < dec->len; i++ )
+        dec->buf[ i ] = dec->buf[ i + n ];
+
+    if ( !dec->synced )
+    {
+        dec->lost++;
+        return 0;
+    }
+
+    dec->timestamp += delta.timestamp;
+    dec->x += delta.x;
+    dec->y += delta.y;
+    dec->frames++;
+
+    record->timestamp = dec->timestamp;
+    record->x = dec->x;
+    record->y = dec->y;
+    record->button = delta.button;
+
+    return 1;
+}
+
+#endif
+
+/* ------------------------------------------------- DEFAULT INSTANCE WRAPPERS */
+
+void joystick_writeByte( uint8_t registerAddress, uint8_t dataWrite )
+{
+    joystick_ctxWriteByte( &_joystick_defaultCtx, registerAddress, dataWrite );
+}
+
+int8_t joystick_readByte( uint8_t registerAddress )
+{
+    return joystick_ctxReadByte( &_joystick_defaultCtx, registerAddress );
+}
+
+void joystick_readData( uint8_t registerAddress, uint8_t *dataBuf, uint8_t nBytes )
+{
+    joystick_ctxReadData( &_joystick_defaultCtx, registerAddress, dataBuf, nBytes );
+}
+
+void joystick_readXY( int8_t *ox, int8_t *oy )
+{
+    joystick_ctxReadXY( &_joystick_defaultCtx, ox, oy );
+}
+
+void joystick_setDefaultConfiguration()
+{
+    joystick_ctxSetDefaultConfiguration( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_checkIdCode()
+{
+    return joystick_ctxCheckIdCode( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_checkIdVersion()
+{
+    return joystick_ctxCheckIdVersion( &_joystick_defaultCtx );
+}
+
+void joystick_setLowPowerMode( uint8_t timings )
+{
+    joystick_ctxSetLowPowerMode( &_joystick_defaultCtx, timings );
+}
+
+void joystick_setScalingFactor( uint8_t scalingFactor )
+{
+    joystick_ctxSetScalingFactor( &_joystick_defaultCtx, scalingFactor );
+}
+
+void joystick_disabledInterrupt()
+{
+    joystick_ctxDisabledInterrupt( &_joystick_defaultCtx );
+}
+
+void joystick_enabledInterrupt()
+{
+    joystick_ctxEnabledInterrupt( &_joystick_defaultCtx );
+}
+
+void joystick_invertSpinning()
+{
+    joystick_ctxInvertSpinning( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_getPosition()
+{
+    return joystick_ctxGetPosition( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_classify( int8_t ox, int8_t oy )
+{
+    return joystick_ctxClassify( &_joystick_defaultCtx, ox, oy );
+}
+
+void joystick_setThresholds( uint8_t lowThreshold, uint8_t highThreshold )
+{
+    joystick_ctxSetThresholds( &_joystick_defaultCtx, lowThreshold, highThreshold );
+}
+
+void joystick_setDeadzone( uint8_t radius, uint8_t hysteresis )
+{
+    joystick_ctxSetDeadzone( &_joystick_defaultCtx, radius, hysteresis );
+}
+
+uint8_t joystick_classifyStable( int8_t ox, int8_t oy )
+{
+    return joystick_ctxClassifyStable( &_joystick_defaultCtx, ox, oy );
+}
+
+uint8_t joystick_updatePosition( int8_t ox, int8_t oy, uint8_t *position )
+{
+    return joystick_ctxUpdatePosition( &_joystick_defaultCtx, ox, oy, position );
+}
+
+uint8_t joystick_getPositionEvent( uint8_t *position )
+{
+    return joystick_ctxGetPositionEvent( &_joystick_defaultCtx, position );
+}
+
+uint8_t joystick_getInterrupt()
+{
+    return joystick_ctxGetInterrupt( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_pressButton()
+{
+    return joystick_ctxPressButton( &_joystick_defaultCtx );
+}
+
+void joystick_softReset()
+{
+    joystick_ctxSoftReset( &_joystick_defaultCtx );
+}
+
+void joystick_hardwareReset()
+{
+    joystick_ctxHardwareReset( &_joystick_defaultCtx );
+}
+
+void joystick_invalidateShadow()
+{
+    joystick_ctxInvalidateShadow( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_getI2cError()
+{
+    return joystick_ctxGetI2cError( &_joystick_defaultCtx );
+}
+
+void joystick_startEventMode()
+{
+    joystick_ctxStartEventMode( &_joystick_defaultCtx );
+}
+
+void joystick_isrHandler()
+{
+    joystick_ctxIsrHandler( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_popSample( T_joystick_sample *sample )
+{
+    return joystick_ctxPopSample( &_joystick_defaultCtx, sample );
+}
+
+uint8_t joystick_getDroppedSamples()
+{
+    return joystick_ctxGetDroppedSamples( &_joystick_defaultCtx );
+}
+
+void joystick_getVector( T_joystick_vector *vector )
+{
+    joystick_ctxGetVector( &_joystick_defaultCtx, vector );
+}
+
+void joystick_computeVector( int8_t ox, int8_t oy, T_joystick_vector *vector )
+{
+    joystick_ctxComputeVector( &_joystick_defaultCtx, ox, oy, vector );
+}
+
+void joystick_process( int8_t *ox, int8_t *oy )
+{
+    joystick_ctxProcess( &_joystick_defaultCtx, ox, oy );
+}
+
+void joystick_setCalibrationMode( uint8_t mode )
+{
+    joystick_ctxSetCalibrationMode( &_joystick_defaultCtx, mode );
+}
+
+void joystick_setCalibrationDecay( uint8_t decayShift )
+{
+    joystick_ctxSetCalibrationDecay( &_joystick_defaultCtx, decayShift );
+}
+
+void joystick_resetCalibration()
+{
+    joystick_ctxResetCalibration( &_joystick_defaultCtx );
+}
+
+void joystick_setFilter( uint8_t type, uint8_t param1, uint8_t param2 )
+{
+    joystick_ctxSetFilter( &_joystick_defaultCtx, type, param1, param2 );
+}
+
+void joystick_getCalibration( uint8_t *blob )
+{
+    joystick_ctxGetCalibration( &_joystick_defaultCtx, blob );
+}
+
+uint8_t joystick_setCalibration( const uint8_t *blob )
+{
+    return joystick_ctxSetCalibration( &_joystick_defaultCtx, blob );
+}
+
+void joystick_setTimeSource( T_joystick_timeFp timeSource )
+{
+    joystick_ctxSetTimeSource( &_joystick_defaultCtx, timeSource );
+}
+
+void joystick_sampleBatch( T_joystick_record *buf, uint8_t n, uint32_t periodUs )
+{
+    joystick_ctxSampleBatch( &_joystick_defaultCtx, buf, n, periodUs );
+}
+
+void joystick_setButtonTiming( uint16_t tickUs, uint8_t debounceTicks, uint16_t longPressTicks, uint16_t doubleClickTicks )
+{
+    joystick_ctxSetButtonTiming( &_joystick_defaultCtx, tickUs, debounceTicks, longPressTicks, doubleClickTicks );
+}
+
+void joystick_buttonTick()
+{
+    joystick_ctxButtonTick( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_buttonBusy()
+{
+    return joystick_ctxButtonBusy( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_getButtonState()
+{
+    return joystick_ctxGetButtonState( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_popButtonEvent( T_joystick_buttonEvent *event )
+{
+    return joystick_ctxPopButtonEvent( &_joystick_defaultCtx, event );
+}
+
+uint8_t joystick_getDroppedButtonEvents()
+{
+    return joystick_ctxGetDroppedButtonEvents( &_joystick_defaultCtx );
+}
+
+void joystick_setAdaptiveRate( uint16_t minPeriod, uint16_t maxPeriod, uint8_t deltaThreshold, uint8_t idleSamples )
+{
+    joystick_ctxSetAdaptiveRate( &_joystick_defaultCtx, minPeriod, maxPeriod, deltaThreshold, idleSamples );
+}
+
+void joystick_setRateAlignment( uint8_t enable )
+{
+    joystick_ctxSetRateAlignment( &_joystick_defaultCtx, enable );
+}
+
+uint16_t joystick_updateRate( int8_t ox, int8_t oy )
+{
+    return joystick_ctxUpdateRate( &_joystick_defaultCtx, ox, oy );
+}
+
+#ifdef __JOYSTICK_STATS__
+void joystick_getStats( T_joystick_stats *stats )
+{
+    joystick_ctxGetStats( &_joystick_defaultCtx, stats );
+}
+
+void joystick_resetStats()
+{
+    joystick_ctxResetStats( &_joystick_defaultCtx );
+}
+#endif
+
+#ifdef __JOYSTICK_TELEMETRY__
+void joystick_telemetryReset()
+{
+    joystick_ctxTelemetryReset( &_joystick_defaultCtx );
+}
+
+uint8_t joystick_telemetryEncode( T_joystick_record *record, uint8_t *frame )
+{
+    return joystick_ctxTelemetryEncode( &_joystick_defaultCtx, record, frame );
+}
+#endif
+
 
 
 
@@ -51,6 +51,29 @@
    #define   __JOYSTICK_DRV_I2C__                            /**<     @macro __JOYSTICK_DRV_I2C__  @brief I2C driver selector */                                          
 // #define   __JOYSTICK_DRV_UART__                           /**<     @macro __JOYSTICK_DRV_UART__ @brief UART driver selector */ 
 
+// #define   __JOYSTICK_STATS__                             /**<     @macro __JOYSTICK_STATS__    @brief I2C bus cost counters selector */
+// #define   __JOYSTICK_TELEMETRY__                         /**<     @macro __JOYSTICK_TELEMETRY__    @brief Binary telemetry encoder / decoder selector */
+
+#ifndef _JOYSTICK_RING_SIZE
+   #define   _JOYSTICK_RING_SIZE       8                     /**<     @macro _JOYSTICK_RING_SIZE   @brief Event mode sample ring capacity ( power of 2, max 128 ) */
+#endif
+
+#ifndef _JOYSTICK_BUTTON_QUEUE_SIZE
+   #define   _JOYSTICK_BUTTON_QUEUE_SIZE   4                 /**<     @macro _JOYSTICK_BUTTON_QUEUE_SIZE   @brief Button event queue capacity ( power of 2, max 128 ) */
+#endif
+
+#ifndef _JOYSTICK_TASK_MAX
+   #define   _JOYSTICK_TASK_MAX        4                     /**<     @macro _JOYSTICK_TASK_MAX    @brief Number of task runner slots */
+#endif
+
+#ifndef _JOYSTICK_LOG_SIZE
+   #define   _JOYSTICK_LOG_SIZE        16                    /**<     @macro _JOYSTICK_LOG_SIZE    @brief Event logger ring capacity in records ( power of 2, max 128 ) */
+#endif
+
+#ifndef _JOYSTICK_TELEMETRY_KEY_INTERVAL
+   #define   _JOYSTICK_TELEMETRY_KEY_INTERVAL  32            /**<     @macro _JOYSTICK_TELEMETRY_KEY_INTERVAL  @brief Telemetry frames between key frames, 1 .. 255 */
+#endif
+
                                                                        /** @} */
 /** @defgroup JOYSTICK_VAR Variables */                           /** @{ */
 
@@ -77,11 +100,341 @@ extern const uint8_t _JOYSTICK_T_CTRL_SCALING_90_8_CMD;
 extern const uint8_t _JOYSTICK_T_CTRL_SCALING_100_CMD;
 extern const uint8_t _JOYSTICK_CONTROL1_RESET_CMD;
 extern const uint8_t _JOYSTICK_INVERT_SPINING_CMD;
+extern const uint8_t _JOYSTICK_POSITION_START;
+extern const uint8_t _JOYSTICK_POSITION_TOP;
+extern const uint8_t _JOYSTICK_POSITION_TOP_RIGHT;
+extern const uint8_t _JOYSTICK_POSITION_RIGHT;
+extern const uint8_t _JOYSTICK_POSITION_BOTTOM_RIGHT;
+extern const uint8_t _JOYSTICK_POSITION_BOTTOM;
+extern const uint8_t _JOYSTICK_POSITION_BOTTOM_LEFT;
+extern const uint8_t _JOYSTICK_POSITION_LEFT;
+extern const uint8_t _JOYSTICK_POSITION_TOP_LEFT;
+extern const uint8_t _JOYSTICK_CALIBRATION_OFF;
+extern const uint8_t _JOYSTICK_CALIBRATION_APPLY;
+extern const uint8_t _JOYSTICK_CALIBRATION_LEARN;
+extern const uint8_t _JOYSTICK_FILTER_NONE;
+extern const uint8_t _JOYSTICK_FILTER_IIR;
+extern const uint8_t _JOYSTICK_FILTER_MEDIAN3;
+extern const uint8_t _JOYSTICK_FILTER_MEDIAN5;
+extern const uint8_t _JOYSTICK_FILTER_ADAPTIVE;
+extern const uint8_t _JOYSTICK_BUTTON_PRESS;
+extern const uint8_t _JOYSTICK_BUTTON_RELEASE;
+extern const uint8_t _JOYSTICK_BUTTON_LONG_PRESS;
+extern const uint8_t _JOYSTICK_BUTTON_DOUBLE_CLICK;
+extern const uint8_t _JOYSTICK_LOG_POSITION;
+extern const uint8_t _JOYSTICK_LOG_BUTTON;
 
                                                                        /** @} */
 /** @defgroup JOYSTICK_TYPES Types */                             /** @{ */
 
+/** Number of shadowed writable configuration registers */
+#define _JOYSTICK_SHADOW_SIZE   6
+
+/**
+ * @brief Position sample type
+ *
+ * Raw X and Y results of the AS5013 Hall IC and
+ * the Joystick button ( CS pin ) state captured together.
+ */
+typedef struct
+{
+    int8_t          x;
+    int8_t          y;
+    uint8_t         button;
+
+}T_joystick_sample;
+
+/** Size in bytes of the calibration blob */
+#define _JOYSTICK_CALIBRATION_SIZE  8
+
+/**
+ * @brief Calibration state type
+ *
+ * Center and extents are kept in Q8 ( 1/256 of a result LSB ),
+ * extents are indexed XP, XN, YP, YN, gains are Q8 factors that map
+ * the extent of every half axis onto 127.
+ */
+typedef struct
+{
+    int16_t         centerX;
+    int16_t         centerY;
+    uint16_t        extent[ 4 ];
+    uint16_t        gain[ 4 ];
+    uint8_t         mode;
+    uint8_t         decayShift;
+
+}T_joystick_calib;
+
+/**
+ * @brief Filter state of one axis type
+ *
+ * state is the IIR / adaptive output in Q8, speed the smoothed
+ * change per sample in Q8 ( saturating at 32767 ), history the last raw
+ * values for the median.
+ */
+typedef struct
+{
+    int16_t         state;
+    int16_t         speed;
+    int8_t          history[ 5 ];
+
+}T_joystick_filterAxis;
+
+/**
+ * @brief Filter stage type
+ */
+typedef struct
+{
+    T_joystick_filterAxis       axis[ 2 ];
+    uint8_t                     type;
+    uint8_t                     param1;
+    uint8_t                     param2;
+    uint8_t                     index;
+    uint8_t                     primed;
+
+}T_joystick_filter;
+
+/**
+ * @brief Time source function type
+ *
+ * Returns free running time in microseconds ( wrapping at 2^32 ).
+ */
+typedef uint32_t (*T_joystick_timeFp)();
+
+/**
+ * @brief Task function type
+ *
+ * Task of the cooperative runner, has to return quickly and never block.
+ */
+typedef void (*T_joystick_taskFp)();
+
+/**
+ * @brief Task runner slot type
+ */
+typedef struct
+{
+    T_joystick_taskFp   task;
+    uint16_t            period;
+    uint16_t            remaining;
+
+}T_joystick_task;
+
+/**
+ * @brief UART transmit start function type
+ *
+ * Called by joystick_logEvent() when the transmitter is idle,
+ * typically enables the TX empty interrupt of the UART.
+ */
+typedef void (*T_joystick_logKickFp)();
+
+/**
+ * @brief Event logger record type
+ */
+typedef struct
+{
+    uint8_t         type;
+    uint8_t         value;
+
+}T_joystick_logRecord;
+
+/**
+ * @brief Timestamped sample record type
+ *
+ * Filled by joystick_sampleBatch(), timestamp is in microseconds
+ * from the start of the batch.
+ */
+typedef struct
+{
+    uint32_t        timestamp;
+    int8_t          x;
+    int8_t          y;
+    uint8_t         button;
+
+}T_joystick_record;
+
+/**
+ * @brief Button event type
+ *
+ * type is one of _JOYSTICK_BUTTON_PRESS, _RELEASE, _LONG_PRESS, _DOUBLE_CLICK,
+ * timestamp is in microseconds, from the time source when one is set,
+ * otherwise counted in ticks of joystick_buttonTick().
+ */
+typedef struct
+{
+    uint32_t        timestamp;
+    uint8_t         type;
+
+}T_joystick_buttonEvent;
+
+/**
+ * @brief Button debouncer type
+ *
+ * Integrator debouncer of the CS pin and the click detector state,
+ * all times are counted in ticks.
+ */
+typedef struct
+{
+    uint16_t        tickUs;
+    uint8_t         debounceTicks;
+    uint16_t        longPressTicks;
+    uint16_t        doubleClickTicks;
+
+    uint8_t         integrator;
+    uint8_t         state;
+    uint16_t        timer;
+    uint8_t         longSent;
+    uint8_t         clickPending;
+    uint32_t        ticks;
+
+    T_joystick_buttonEvent      queue[ _JOYSTICK_BUTTON_QUEUE_SIZE ];
+    volatile uint8_t            queueHead;
+    volatile uint8_t            queueTail;
+    volatile uint8_t            queueDropped;
+
+}T_joystick_button;
+
+/**
+ * @brief Adaptive polling rate controller type
+ *
+ * Periods are in milliseconds ( ticks of a 1 ms task runner ).
+ * period is the current period before alignment, alignPeriod the
+ * AS5013 low power timebase reads are aligned to, 0 when not aligned.
+ */
+typedef struct
+{
+    uint16_t        minPeriod;
+    uint16_t        maxPeriod;
+    uint16_t        period;
+    uint16_t        alignPeriod;
+    uint8_t         deltaThreshold;
+    uint8_t         idleSamples;
+    uint8_t         idleCount;
+    uint8_t         primed;
+    int8_t          lastX;
+    int8_t          lastY;
+
+}T_joystick_rate;
+
+/**
+ * @brief Analog stick vector type
+ *
+ * x and y are Q15 fractions of full scale ( 32767 ~ +1.0 ),
+ * magnitude is Q15 length of ( x, y ) and reaches 46341 ( ~ sqrt( 2 ) ) in the corners,
+ * angle is the direction of ( x, y ) from the +X axis towards +Y
+ * in binary units where 32768 is 180 degrees ( -32768 .. 32767 ).
+ * Axes are the sensor axes, +X is left and +Y is top of the stick.
+ */
+typedef struct
+{
+    int16_t         x;
+    int16_t         y;
+    uint16_t        magnitude;
+    int16_t         angle;
+
+}T_joystick_vector;
+
+/**
+ * @brief I2C bus cost counters type
+ *
+ * Available when __JOYSTICK_STATS__ is defined.
+ * Bytes include the slave address bytes of every transfer.
+ */
+typedef struct
+{
+    uint32_t        transactions;
+    uint32_t        bytes;
+    uint32_t        starts;
+    uint32_t        restarts;
+    uint32_t        stops;
+    uint32_t        delayUs;
+
+}T_joystick_stats;
+
+/** Longest telemetry frame in bytes */
+#define _JOYSTICK_TELEMETRY_FRAME_MAX   13
+
+/**
+ * @brief Telemetry encoder state type
+ *
+ * Available when __JOYSTICK_TELEMETRY__ is defined.
+ */
+typedef struct
+{
+    uint8_t         seq;
+    uint8_t         sinceKey;
+    uint32_t        timestamp;
+    int8_t          x;
+    int8_t          y;
+
+}T_joystick_telemetry;
+
+/**
+ * @brief Telemetry decoder state type
+ *
+ * Available when __JOYSTICK_TELEMETRY__ is defined.
+ * frames counts decoded frames, crcErrors frames dropped on a bad CRC
+ * or malformed field, lost frames missing from the sequence
+ * or skipped while waiting for a key frame.
+ */
+typedef struct
+{
+    uint8_t         buf[ _JOYSTICK_TELEMETRY_FRAME_MAX ];
+    uint8_t         len;
+    uint8_t         synced;
+    uint8_t         seq;
+    uint32_t        timestamp;
+    int8_t          x;
+    int8_t          y;
+
+    uint32_t        frames;
+    uint32_t        crcErrors;
+    uint32_t        lost;
+
+}T_joystick_telemetryDecoder;
+
+/**
+ * @brief Driver instance ( context ) type
+ *
+ * Holds everything the driver needs to talk to one Joystick click,
+ * so several clicks can be driven from one firmware image.
+ * Fields are private to the driver, initialize the instance with
+ * joystick_ctxI2cDriverInit() before use.
+ */
+typedef struct
+{
+    T_JOYSTICK_P    gpioObj;
+    T_JOYSTICK_P    i2cObj;
+    uint8_t         slaveAddress;
+    uint8_t         shadow[ _JOYSTICK_SHADOW_SIZE ];
+    uint8_t         shadowValid;
+    uint8_t         i2cError;
+    uint8_t         lowThreshold;
+    uint8_t         highThreshold;
+    uint8_t         deadzone;
+    uint8_t         hysteresis;
+    uint8_t         zoneX;
+    uint8_t         zoneY;
+    uint8_t         inDeadzone;
+    uint8_t         lastPosition;
+    T_joystick_timeFp           timeSource;
+    T_joystick_calib            calib;
+    T_joystick_filter           filter;
+    T_joystick_button           button;
+    T_joystick_rate             rate;
+
+    T_joystick_sample           ring[ _JOYSTICK_RING_SIZE ];
+    volatile uint8_t            ringHead;
+    volatile uint8_t            ringTail;
+    volatile uint8_t            ringDropped;
 
+#ifdef __JOYSTICK_STATS__
+    T_joystick_stats            stats;
+#endif
+#ifdef __JOYSTICK_TELEMETRY__
+    T_joystick_telemetry        telemetry;
+#endif
+
+}T_joystick_ctx;
 
                                                                        /** @} */
 #ifdef __cplusplus
@@ -95,6 +448,7 @@ void joystick_spiDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P spiObj);
 #endif
 #ifdef   __JOYSTICK_DRV_I2C__
 void joystick_i2cDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P i2cObj, uint8_t slave);
+void joystick_ctxI2cDriverInit(T_joystick_ctx *ctx, T_JOYSTICK_P gpioObj, T_JOYSTICK_P i2cObj, uint8_t slave);
 #endif
 #ifdef   __JOYSTICK_DRV_UART__
 void joystick_uartDriverInit(T_JOYSTICK_P gpioObj, T_JOYSTICK_P uartObj);
@@ -129,6 +483,35 @@ void joystick_writeByte( uint8_t registerAddress, uint8_t dataWrite );
  */
 int8_t joystick_readByte( uint8_t registerAddress );
 
+/**
+ * @brief Generic sequential read function
+ *
+ * @param[in] registerAddress                8-bit address of the first register
+ *
+ * @param[out] dataBuf                       pointer to read data buffer
+ *
+ * @param[in] nBytes                         number of bytes to read
+ *
+ * Function reads nBytes consecutive registers of AS5013 Hall IC
+ * starting from registerAddress in a single I2C transaction,
+ * relying on the register address auto-increment of the device.
+ */
+void joystick_readData( uint8_t registerAddress, uint8_t *dataBuf, uint8_t nBytes );
+
+/**
+ * @brief Burst read X and Y position function
+ *
+ * @param[out] ox                            8-bit ( signed ) X result
+ *
+ * @param[out] oy                            8-bit ( signed ) Y result
+ *
+ * Function reads X and Y_res_int registers of AS5013 Hall IC
+ * with one auto-incrementing I2C read ( single START / RESTART / STOP ).
+ * X is read before Y_res_int as required by the device,
+ * reading Y_res_int releases the INT output and starts a new measurement.
+ */
+void joystick_readXY( int8_t *ox, int8_t *oy );
+
 /**
  * @brief Set default configuration function
  *
@@ -181,7 +564,7 @@ uint8_t joystick_checkIdVersion();
  * - 6 : 260 ms;
  * - 7 : 320 ms;
  */
-void joystick_setLowPowerMode();
+void joystick_setLowPowerMode( uint8_t timings );
 
 /**
  * @brief Set scaling factor function
@@ -228,6 +611,11 @@ void joystick_setScalingFactor( uint8_t scalingFactor );
  * @brief Set interrupt disabled function
  *
  * Function set interrupt output is disabled.
+ *
+ * @note
+ * Control Register 1 is taken from the driver shadow and written back
+ * without the Soft_rst bit, so the change costs a single I2C write
+ * and the shadow stays valid.
  */
 void joystick_disabledInterrupt();
 
@@ -235,6 +623,11 @@ void joystick_disabledInterrupt();
  * @brief Set interrupt enabled function
  *
  * Function set interrupt output is enabled.
+ *
+ * @note
+ * Control Register 1 is taken from the driver shadow and written back
+ * without the Soft_rst bit, so the change costs a single I2C write
+ * and the shadow stays valid.
  */
 void joystick_enabledInterrupt();
 
@@ -264,9 +657,99 @@ void joystick_invertSpinning();
  * Function get position of miniature joystick module ( N50P105 ),
  * return position state value from 0 to 8 that calculeted
  * by the value read from the register of the AS5013 Hall IC.
+ * X and Y are fetched with joystick_readXY() and classified by joystick_classify().
  */
 uint8_t joystick_getPosition();
 
+/**
+ * @brief Classify X and Y results into position function
+ *
+ * @param[in] ox                             8-bit ( signed ) X result
+ *
+ * @param[in] oy                             8-bit ( signed ) Y result
+ *
+ * @return position, same coding as joystick_getPosition()
+ *
+ * Function quantises each axis into five zones with the low and high thresholds
+ * ( strong negative, weak negative, center, weak positive, strong positive )
+ * and looks the position up in a constant 5x5 table, so the cost does not depend
+ * on the input. Every deflection past the low threshold yields a direction.
+ */
+uint8_t joystick_classify( int8_t ox, int8_t oy );
+
+/**
+ * @brief Set direction thresholds function
+ *
+ * @param[in] lowThreshold                   deflection of an axis that counts as a direction ( default 20 )
+ *
+ * @param[in] highThreshold                  deflection of an axis that dominates a weak other axis ( default 60 )
+ *
+ * Function sets the thresholds used by joystick_classify(),
+ * lowThreshold is limited to at least 1, highThreshold to
+ * at most 127 and above lowThreshold.
+ */
+void joystick_setThresholds( uint8_t lowThreshold, uint8_t highThreshold );
+
+/**
+ * @brief Set deadzone and hysteresis function
+ *
+ * @param[in] radius                         radial deadzone around the center, 0 disables it ( default 0 )
+ *
+ * @param[in] hysteresis                     width of the hysteresis band at every boundary ( default 4 )
+ *
+ * Function configures joystick_updatePosition(). Inside the radius the position is Start,
+ * the stick leaves the deadzone only past radius + hysteresis. An axis changes zone only
+ * when it is more than hysteresis beyond the threshold between the zones,
+ * so a stick resting near a boundary does not chatter between two positions.
+ */
+void joystick_setDeadzone( uint8_t radius, uint8_t hysteresis );
+
+/**
+ * @brief Classify with deadzone and hysteresis function
+ *
+ * @param[in] ox                             8-bit ( signed ) X result
+ *
+ * @param[in] oy                             8-bit ( signed ) Y result
+ *
+ * @return position, same coding as joystick_getPosition()
+ *
+ * Function classifies like joystick_classify() but applies the radial deadzone
+ * and keeps the previous zone of an axis while it stays within the hysteresis band.
+ */
+uint8_t joystick_classifyStable( int8_t ox, int8_t oy );
+
+/**
+ * @brief Feed sample to direction tracker function
+ *
+ * @param[in] ox                             8-bit ( signed ) processed X
+ *
+ * @param[in] oy                             8-bit ( signed ) processed Y
+ *
+ * @param[out] position                      new position, written only on change
+ *
+ * @return
+ * - 1 : position changed;
+ * - 0 : no change;
+ *
+ * Function runs joystick_classifyStable() on the sample and reports
+ * a direction change event only on a real transition.
+ */
+uint8_t joystick_updatePosition( int8_t ox, int8_t oy, uint8_t *position );
+
+/**
+ * @brief Get position change event function
+ *
+ * @param[out] position                      new position, written only on change
+ *
+ * @return
+ * - 1 : position changed;
+ * - 0 : no change;
+ *
+ * Function reads X and Y with one burst read, runs them through joystick_process()
+ * and joystick_updatePosition().
+ */
+uint8_t joystick_getPositionEvent( uint8_t *position );
+
 /**
  * @brief Get state of interrupt pin function
  *
@@ -311,6 +794,932 @@ void joystick_softReset();
  */
 void joystick_hardwareReset();
 
+/**
+ * @brief Invalidate configuration register shadow function
+ *
+ * Function marks the driver side copy of the writable configuration registers
+ * ( Control 1, Control 2, AGC, M_ctrl, J_ctrl and T_ctrl ) as stale,
+ * so the next read-modify-write of any of them fetches the register over I2C.
+ *
+ * @note
+ * Shadow is kept coherent by joystick_writeByte() and is invalidated by every
+ * write setting the Soft_rst bit of Control 1 ( joystick_softReset() and
+ * joystick_setDefaultConfiguration() ) and by joystick_hardwareReset().
+ * joystick_enabledInterrupt() and joystick_disabledInterrupt() do not set
+ * Soft_rst and keep the shadow valid. Call this function
+ * only if the AS5013 was reset or reconfigured bypassing the driver.
+ */
+void joystick_invalidateShadow();
+
+/**
+ * @brief Get I2C error function
+ *
+ * @retval 1 if a register write or read failed on the bus since the last call, 0 otherwise
+ *
+ * Function returns and clears the error flag latched by joystick_writeByte() and
+ * joystick_readData(). Data returned by a failed read is not a sample, the
+ * platform HAL fills it with zeros at best, so clear the flag before a read
+ * and drop its result when the flag is set after it.
+ */
+uint8_t joystick_getI2cError();
+
+/**
+ * @brief Start event mode function
+ *
+ * Function empties the sample ring and enables the INT output of the AS5013 Hall IC.
+ * After this call the application enables the MCU external interrupt
+ * on the falling edge of the INT pin and calls joystick_isrHandler() from it.
+ */
+void joystick_startEventMode();
+
+/**
+ * @brief Event mode interrupt handler function
+ *
+ * Function captures X, Y ( one burst read ) and the button state
+ * into the sample ring. Reading Y_res_int releases the INT output.
+ * When the ring is full the new sample is dropped and counted.
+ *
+ * @note
+ * Must be called only from the INT pin interrupt routine.
+ * The ring is single producer ( this handler ) / single consumer ( joystick_popSample() )
+ * and lock-free. While event mode is active any other driver call that uses I2C or GPIO
+ * must be made with the INT interrupt disabled, as it shares the bus with this handler.
+ * This holds for every instance on the same I2C bus, not only the one in event mode :
+ * the handler of instance B interrupting a transfer of instance A on that bus starts
+ * its own transfer in the middle of A's and corrupts both.
+ * The handler maps back the instance that was active when it returns, so a transfer of
+ * an instance on another bus goes on with its own bus and pins.
+ */
+void joystick_isrHandler();
+
+/**
+ * @brief Pop sample from event ring function
+ *
+ * @param[out] sample                        oldest captured sample
+ *
+ * @return
+ * - 1 : sample returned;
+ * - 0 : ring is empty;
+ *
+ * Function takes the oldest sample captured by joystick_isrHandler(),
+ * it does not access the I2C bus and is safe to call with interrupts enabled.
+ */
+uint8_t joystick_popSample( T_joystick_sample *sample );
+
+/**
+ * @brief Get number of dropped samples function
+ *
+ * @return number of samples dropped because the ring was full ( wraps at 255 )
+ */
+uint8_t joystick_getDroppedSamples();
+
+/**
+ * @brief Get analog vector function
+ *
+ * @param[out] vector                        Q15 position, magnitude and angle
+ *
+ * Function reads X and Y with one burst read and converts them with joystick_computeVector().
+ */
+void joystick_getVector( T_joystick_vector *vector );
+
+/**
+ * @brief Compute analog vector function
+ *
+ * @param[in] ox                             8-bit ( signed ) X result
+ *
+ * @param[in] oy                             8-bit ( signed ) Y result
+ *
+ * @param[out] vector                        Q15 position, magnitude and angle
+ *
+ * Function scales X and Y to Q15 and computes magnitude and angle with a
+ * 15 iteration integer CORDIC ( shifts, adds and a 15 entry arctangent table ),
+ * no floating point or math library is used.
+ */
+void joystick_computeVector( int8_t ox, int8_t oy, T_joystick_vector *vector );
+
+/**
+ * @brief Process raw sample function
+ *
+ * @param[in,out] ox                         8-bit ( signed ) X result, replaced by the processed value
+ *
+ * @param[in,out] oy                         8-bit ( signed ) Y result, replaced by the processed value
+ *
+ * Function runs a raw sample through the conditioning pipeline of the driver
+ * ( calibration, then filter ), joystick_getPosition() and joystick_getVector() use it on every sample.
+ * Raw samples from joystick_readXY(), joystick_sampleBatch() and the event ring can be
+ * passed through it later.
+ */
+void joystick_process( int8_t *ox, int8_t *oy );
+
+/**
+ * @brief Set calibration mode function
+ *
+ * @param[in] mode                           calibration mode
+ * - _JOYSTICK_CALIBRATION_OFF   : samples are not corrected;
+ * - _JOYSTICK_CALIBRATION_APPLY : samples are corrected with the current calibration;
+ * - _JOYSTICK_CALIBRATION_LEARN : calibration is updated from every sample and applied;
+ *
+ * While learning, samples within the low threshold of the center move the center
+ * ( one-pole average over 64 samples ), and deflections beyond it extend the extent
+ * of their half axis or let it decay towards the deflection.
+ * Correction costs a subtraction, a multiplication and a shift per axis.
+ */
+void joystick_setCalibrationMode( uint8_t mode );
+
+/**
+ * @brief Set calibration extent decay function
+ *
+ * @param[in] decayShift                     extent decays by 1/2^decayShift of the excess per deflected sample ( default 8 )
+ *
+ * Function sets how fast learned extents shrink back when the stick no longer
+ * reaches them, 0 disables the decay.
+ */
+void joystick_setCalibrationDecay( uint8_t decayShift );
+
+/**
+ * @brief Reset calibration function
+ *
+ * Function sets center to ( 0, 0 ) and all extents to 127 ( no correction ).
+ */
+void joystick_resetCalibration();
+
+/**
+ * @brief Set filter function
+ *
+ * @param[in] type                           filter applied to both axes
+ * - _JOYSTICK_FILTER_NONE     : no filtering;
+ * - _JOYSTICK_FILTER_IIR      : one-pole low pass, y += ( x - y ) / 2^param1;
+ * - _JOYSTICK_FILTER_MEDIAN3  : median of the last 3 samples;
+ * - _JOYSTICK_FILTER_MEDIAN5  : median of the last 5 samples;
+ * - _JOYSTICK_FILTER_ADAPTIVE : one-pole low pass whose coefficient grows with stick speed ( 1 Euro style ),
+ *                               param1 is the coefficient at rest in 1/256 units,
+ *                               param2 the coefficient added per LSB / sample of smoothed speed;
+ *
+ * @param[in] param1                         see type ( IIR : 1 .. 7, default 2; adaptive : default 16 )
+ *
+ * @param[in] param2                         see type ( adaptive : default 32 )
+ *
+ * Function selects the filter stage of joystick_process() and clears its state,
+ * the next sample primes it. Every filter runs in integer arithmetic
+ * with constant cost per sample and 9 bytes of state per axis.
+ * The adaptive filter smooths jitter at rest while following fast moves
+ * with little lag, medians remove single sample spikes.
+ * A parameter of 0 selects its default.
+ */
+void joystick_setFilter( uint8_t type, uint8_t param1, uint8_t param2 );
+
+/**
+ * @brief Get calibration blob function
+ *
+ * @param[out] blob                          _JOYSTICK_CALIBRATION_SIZE bytes
+ *
+ * Function serializes the calibration for storage in EEPROM or flash :
+ * version, center X, center Y, extent XP, XN, YP, YN and a checksum byte.
+ */
+void joystick_getCalibration( uint8_t *blob );
+
+/**
+ * @brief Set calibration blob function
+ *
+ * @param[in] blob                           _JOYSTICK_CALIBRATION_SIZE bytes from joystick_getCalibration()
+ *
+ * @return
+ * - 1 : calibration loaded;
+ * - 0 : wrong version or checksum, calibration unchanged;
+ */
+uint8_t joystick_setCalibration( const uint8_t *blob );
+
+/**
+ * @brief Set time source function
+ *
+ * @param[in] timeSource                     function returning microseconds, 0 to remove
+ *
+ * Function sets the clock used for pacing and timestamps,
+ * typically a free running timer of the MCU.
+ */
+void joystick_setTimeSource( T_joystick_timeFp timeSource );
+
+/**
+ * @brief Batched sampling function
+ *
+ * @param[out] buf                           caller owned array of at least n records
+ *
+ * @param[in] n                              number of samples
+ *
+ * @param[in] periodUs                       sampling period in microseconds
+ *
+ * Function takes n samples of X, Y ( one burst read each ) and button state
+ * spaced by periodUs and stores them with timestamps into buf.
+ * With a time source the samples are taken on a fixed schedule from the first one
+ * and stamped with the measured time. Without a time source the driver waits
+ * periodUs between samples with Delay_10us() and stamps the nominal time,
+ * so the actual period is longer by the bus time of one sample.
+ */
+void joystick_sampleBatch( T_joystick_record *buf, uint8_t n, uint32_t periodUs );
+
+/**
+ * @brief Set button debounce timing function
+ *
+ * @param[in] tickUs                         period of joystick_buttonTick() calls in microseconds ( default 1000 )
+ *
+ * @param[in] debounceTicks                  ticks the pin has to hold a new level, 1 .. 255 ( default 10 )
+ *
+ * @param[in] longPressTicks                 hold time for long press, 0 disables it ( default 800 )
+ *
+ * @param[in] doubleClickTicks               longest release to press gap of a double click, 0 disables it ( default 300 )
+ *
+ * Function sets the time constants of the button engine and resets its state.
+ */
+void joystick_setButtonTiming( uint16_t tickUs, uint8_t debounceTicks, uint16_t longPressTicks, uint16_t doubleClickTicks );
+
+/**
+ * @brief Button tick function
+ *
+ * Function samples the button ( CS ) pin and advances the debouncer.
+ * The integrator counts up while the pin is high and down while it is low,
+ * the debounced state changes only when it reaches debounceTicks or 0,
+ * so a bouncing contact is filtered without any delay in the main loop.
+ * Emits _JOYSTICK_BUTTON_PRESS and _RELEASE on debounced edges,
+ * _LONG_PRESS once when the button is held for longPressTicks and
+ * _DOUBLE_CLICK together with the press that follows a short click
+ * within doubleClickTicks.
+ *
+ * @note
+ * Call from a periodic timer interrupt at tickUs. To keep the timer off while
+ * the button is idle, start it from a pin change interrupt of the CS pin and
+ * stop it when joystick_buttonBusy() returns 0.
+ * With several instances the tick maps its own pins to read the button and
+ * maps back the instance that was active, so a transfer of another instance
+ * interrupted by the tick goes on with its own bus and pins.
+ */
+void joystick_buttonTick();
+
+/**
+ * @brief Button engine busy function
+ *
+ * @return
+ * - 1 : debouncer or click detector still needs ticks;
+ * - 0 : idle, ticks can stop until the next pin change;
+ */
+uint8_t joystick_buttonBusy();
+
+/**
+ * @brief Get debounced button state function
+ *
+ * @return
+ * - 0 : not active;
+ * - 1 : active;
+ */
+uint8_t joystick_getButtonState();
+
+/**
+ * @brief Pop button event function
+ *
+ * @param[out] event                         oldest event
+ *
+ * @return
+ * - 1 : event popped;
+ * - 0 : queue empty;
+ *
+ * Events are queued by joystick_buttonTick(),
+ * single producer / single consumer like the event mode sample ring.
+ */
+uint8_t joystick_popButtonEvent( T_joystick_buttonEvent *event );
+
+/**
+ * @brief Get number of dropped button events function
+ *
+ * @return number of events lost because the queue was full ( wraps at 256 )
+ */
+uint8_t joystick_getDroppedButtonEvents();
+
+/**
+ * @brief Set adaptive polling rate function
+ *
+ * @param[in] minPeriod                      shortest sampling period in ms, used while the stick moves ( default 10 )
+ *
+ * @param[in] maxPeriod                      longest sampling period in ms, reached while the stick rests ( default 10 )
+ *
+ * @param[in] deltaThreshold                 X or Y change between two samples that counts as movement ( default 4 )
+ *
+ * @param[in] idleSamples                    samples at rest before the period doubles, 1 .. 255 ( default 8 )
+ *
+ * Function configures the rate controller of joystick_updateRate() and restarts it at minPeriod.
+ * With the defaults the period stays at 10 ms.
+ */
+void joystick_setAdaptiveRate( uint16_t minPeriod, uint16_t maxPeriod, uint8_t deltaThreshold, uint8_t idleSamples );
+
+/**
+ * @brief Set rate alignment to the low power timebase function
+ *
+ * @param[in] enable                         1 : align to the timebase of joystick_setLowPowerMode(), 0 : off
+ *
+ * In low power mode the AS5013 measures once per timebase period ( 20 .. 320 ms ),
+ * faster reads return the same result. With alignment on, joystick_updateRate()
+ * returns whole multiples of that period, so no read is spent on a stale result.
+ * The timebase is read from Control register 1 now and followed on later
+ * joystick_setLowPowerMode() calls.
+ */
+void joystick_setRateAlignment( uint8_t enable );
+
+/**
+ * @brief Update adaptive polling rate function
+ *
+ * @param[in] ox                             X of the sample just taken
+ *
+ * @param[in] oy                             Y of the sample just taken
+ *
+ * @return period in ms until the next sample should be taken
+ *
+ * Function feeds one sample to the rate controller. A change of X or Y larger
+ * than the delta threshold returns to the shortest period at once; every
+ * idleSamples samples with the stick inside the low threshold of the
+ * classifier and no movement double the period, up to the longest one.
+ * A stick held still off center keeps the current period.
+ * Pass the samples the application classifies, raw or after joystick_process().
+ */
+uint16_t joystick_updateRate( int8_t ox, int8_t oy );
+
+/**
+ * @brief Task runner initialization function
+ *
+ * Function removes all tasks and clears the tick count.
+ * The runner is shared by the whole application, it has no instance variant.
+ */
+void joystick_taskInit();
+
+/**
+ * @brief Add task function
+ *
+ * @param[in] task                           task function
+ *
+ * @param[in] period                         period in ticks, 1 .. 65535
+ *
+ * @param[in] offset                         ticks until the first run, spreads tasks of equal period
+ *
+ * @return
+ * - 1 : task added;
+ * - 0 : all _JOYSTICK_TASK_MAX slots are used;
+ */
+uint8_t joystick_taskAdd( T_joystick_taskFp task, uint16_t period, uint16_t offset );
+
+/**
+ * @brief Change task period function
+ *
+ * @param[in] task                           task function given to joystick_taskAdd()
+ *
+ * @param[in] period                         new period in ticks, 1 .. 65535
+ *
+ * @return
+ * - 1 : period changed;
+ * - 0 : task not found;
+ *
+ * A shorter period applies from now, a longer one moves the next run later
+ * by the difference. Called from the task itself, the new period counts
+ * from the current run ( e.g. with the period from joystick_updateRate() ).
+ */
+uint8_t joystick_taskSetPeriod( T_joystick_taskFp task, uint16_t period );
+
+/**
+ * @brief Task runner tick function
+ *
+ * Function advances the runner time base by one tick,
+ * call it from a periodic timer interrupt ( e.g. 1 ms ).
+ * Only an 8-bit counter is touched, so it is safe against joystick_taskRun()
+ * on 8-bit MCUs without disabling interrupts.
+ */
+void joystick_taskTick();
+
+/**
+ * @brief Run due tasks function
+ *
+ * @return number of tasks run
+ *
+ * Function runs every task whose period elapsed since the last call, in slot order,
+ * and returns without waiting. Call it from the main loop as often as possible;
+ * up to 255 ticks of main loop latency are caught up, a task that fell behind
+ * by a whole period runs once and keeps its phase.
+ */
+uint8_t joystick_taskRun();
+
+/**
+ * @brief Event logger initialization function
+ *
+ * @param[in] kick                           transmit start function, 0 when the log is drained by polling
+ *
+ * Function empties the log and clears the drop counter.
+ * The logger is shared by the whole application, it has no instance variant.
+ */
+void joystick_logInit( T_joystick_logKickFp kick );
+
+/**
+ * @brief Log event function
+ *
+ * @param[in] type                           _JOYSTICK_LOG_POSITION or _JOYSTICK_LOG_BUTTON
+ *
+ * @param[in] value                          position, or button event type
+ *
+ * @return
+ * - 1 : event queued;
+ * - 0 : log full, event counted as dropped;
+ *
+ * Function stores a 2 byte record and returns at once, the text is produced
+ * while draining. Records are printed as one line each, e.g. "Top-Right" or "Button pressed".
+ * Events may be logged from the main loop or from one interrupt, not from both.
+ */
+uint8_t joystick_logEvent( uint8_t type, uint8_t value );
+
+/**
+ * @brief Get next log byte function
+ *
+ * @param[out] byte                          next character to send
+ *
+ * @return
+ * - 1 : byte valid, write it to the UART;
+ * - 0 : log empty, disable the TX empty interrupt;
+ *
+ * Call from the TX empty interrupt of the UART, or poll it from a task
+ * when the UART transmitter is free.
+ */
+uint8_t joystick_logTxByte( uint8_t *byte );
+
+/**
+ * @brief Get number of dropped log events function
+ *
+ * @return number of events lost because the log was full ( saturates at 65535 )
+ */
+uint16_t joystick_logGetDropped();
+
+#ifdef __JOYSTICK_STATS__
+/**
+ * @brief Get I2C bus cost counters function
+ *
+ * @param[out] stats                         counters accumulated since init or last reset
+ *
+ * Function copies the number of I2C transactions, bytes on the bus,
+ * START / RESTART / STOP conditions and the time spent in driver busy-waits.
+ *
+ * @note
+ * Available only when __JOYSTICK_STATS__ is defined, otherwise the
+ * counters are compiled out of the driver.
+ */
+void joystick_getStats( T_joystick_stats *stats );
+
+/**
+ * @brief Reset I2C bus cost counters function
+ */
+void joystick_resetStats();
+#endif
+
+#ifdef __JOYSTICK_TELEMETRY__
+/**
+ * @brief Reset telemetry encoder function
+ *
+ * Function restarts the sequence at 0 and makes the next frame a key frame.
+ */
+void joystick_telemetryReset();
+
+/**
+ * @brief Encode telemetry frame function
+ *
+ * @param[in] record                         sample to encode ( e.g. from joystick_sampleBatch() )
+ *
+ * @param[out] frame                         caller owned buffer of _JOYSTICK_TELEMETRY_FRAME_MAX bytes
+ *
+ * @return frame length in bytes
+ *
+ * Frame layout :
+ * - 0xA5 sync byte;
+ * - sequence number, 8-bit wrapping;
+ * - flags, bit 0 button, bit 1 key frame, other bits 0;
+ * - timestamp as unsigned LEB128 varint, microseconds since the previous frame
+ *   ( absolute in a key frame );
+ * - X and Y as zig-zag LEB128 varints, change since the previous frame
+ *   ( absolute in a key frame );
+ * - CRC-8 ( polynomial 0x07, initial value 0 ) of all bytes after the sync byte.
+ *
+ * A typical frame at a steady rate is 7 - 8 bytes. Every
+ * _JOYSTICK_TELEMETRY_KEY_INTERVAL frames a key frame lets a decoder recover
+ * from lost bytes.
+ *
+ * @note
+ * Available only when __JOYSTICK_TELEMETRY__ is defined.
+ */
+uint8_t joystick_telemetryEncode( T_joystick_record *record, uint8_t *frame );
+
+/**
+ * @brief Telemetry decoder initialization function
+ *
+ * @param[out] dec                           decoder state
+ */
+void joystick_telemetryDecoderInit( T_joystick_telemetryDecoder *dec );
+
+/**
+ * @brief Decode telemetry byte function
+ *
+ * @param[in] dec                            decoder state
+ *
+ * @param[in] byte                           next byte of the stream
+ *
+ * @param[out] record                        decoded sample
+ *
+ * @return
+ * - 1 : record holds a decoded sample;
+ * - 0 : more bytes needed;
+ *
+ * Function resynchronizes on the next sync byte after a bad frame and
+ * skips delta frames until a key frame after a gap in the sequence.
+ * The decoder has no instance variant, the state is passed in.
+ */
+uint8_t joystick_telemetryDecode( T_joystick_telemetryDecoder *dec, uint8_t byte, T_joystick_record *record );
+#endif
+
+                                                                       /** @} */
+/** @defgroup JOYSTICK_CTX Instance Functions */                  /** @{ */
+
+/*
+ * Every function of this group is the instance variant of the global
+ * function of the same name without the "ctx" part. Global functions
+ * operate on the default instance set up by joystick_i2cDriverInit().
+ * The I2C and GPIO objects of an instance are mapped to the HAL
+ * only when a call addresses a different instance than the previous one.
+ */
+
+/**
+ * @brief Instance variant of joystick_writeByte()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxWriteByte( T_joystick_ctx *ctx, uint8_t registerAddress, uint8_t dataWrite );
+
+/**
+ * @brief Instance variant of joystick_readByte()
+ *
+ * @param[in] ctx                            driver instance
+ */
+int8_t joystick_ctxReadByte( T_joystick_ctx *ctx, uint8_t registerAddress );
+
+/**
+ * @brief Instance variant of joystick_readData()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxReadData( T_joystick_ctx *ctx, uint8_t registerAddress, uint8_t *dataBuf, uint8_t nBytes );
+
+/**
+ * @brief Instance variant of joystick_readXY()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxReadXY( T_joystick_ctx *ctx, int8_t *ox, int8_t *oy );
+
+/**
+ * @brief Instance variant of joystick_setDefaultConfiguration()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetDefaultConfiguration( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_checkIdCode()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxCheckIdCode( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_checkIdVersion()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxCheckIdVersion( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_setLowPowerMode()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetLowPowerMode( T_joystick_ctx *ctx, uint8_t timings );
+
+/**
+ * @brief Instance variant of joystick_setScalingFactor()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetScalingFactor( T_joystick_ctx *ctx, uint8_t scalingFactor );
+
+/**
+ * @brief Instance variant of joystick_disabledInterrupt()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxDisabledInterrupt( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_enabledInterrupt()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxEnabledInterrupt( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_invertSpinning()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxInvertSpinning( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_getPosition()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetPosition( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_classify()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxClassify( T_joystick_ctx *ctx, int8_t ox, int8_t oy );
+
+/**
+ * @brief Instance variant of joystick_setThresholds()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetThresholds( T_joystick_ctx *ctx, uint8_t lowThreshold, uint8_t highThreshold );
+
+/**
+ * @brief Instance variant of joystick_setDeadzone()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetDeadzone( T_joystick_ctx *ctx, uint8_t radius, uint8_t hysteresis );
+
+/**
+ * @brief Instance variant of joystick_classifyStable()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxClassifyStable( T_joystick_ctx *ctx, int8_t ox, int8_t oy );
+
+/**
+ * @brief Instance variant of joystick_updatePosition()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxUpdatePosition( T_joystick_ctx *ctx, int8_t ox, int8_t oy, uint8_t *position );
+
+/**
+ * @brief Instance variant of joystick_getPositionEvent()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetPositionEvent( T_joystick_ctx *ctx, uint8_t *position );
+
+/**
+ * @brief Instance variant of joystick_getInterrupt()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetInterrupt( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_pressButton()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxPressButton( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_softReset()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSoftReset( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_hardwareReset()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxHardwareReset( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_invalidateShadow()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxInvalidateShadow( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_getI2cError()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetI2cError( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_startEventMode()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxStartEventMode( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_isrHandler()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxIsrHandler( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_popSample()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxPopSample( T_joystick_ctx *ctx, T_joystick_sample *sample );
+
+/**
+ * @brief Instance variant of joystick_getDroppedSamples()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetDroppedSamples( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_getVector()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxGetVector( T_joystick_ctx *ctx, T_joystick_vector *vector );
+
+/**
+ * @brief Instance variant of joystick_computeVector()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxComputeVector( T_joystick_ctx *ctx, int8_t ox, int8_t oy, T_joystick_vector *vector );
+
+/**
+ * @brief Instance variant of joystick_process()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxProcess( T_joystick_ctx *ctx, int8_t *ox, int8_t *oy );
+
+/**
+ * @brief Instance variant of joystick_setCalibrationMode()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetCalibrationMode( T_joystick_ctx *ctx, uint8_t mode );
+
+/**
+ * @brief Instance variant of joystick_setCalibrationDecay()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetCalibrationDecay( T_joystick_ctx *ctx, uint8_t decayShift );
+
+/**
+ * @brief Instance variant of joystick_resetCalibration()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxResetCalibration( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_setFilter()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetFilter( T_joystick_ctx *ctx, uint8_t type, uint8_t param1, uint8_t param2 );
+
+/**
+ * @brief Instance variant of joystick_getCalibration()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxGetCalibration( T_joystick_ctx *ctx, uint8_t *blob );
+
+/**
+ * @brief Instance variant of joystick_setCalibration()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxSetCalibration( T_joystick_ctx *ctx, const uint8_t *blob );
+
+/**
+ * @brief Instance variant of joystick_setTimeSource()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetTimeSource( T_joystick_ctx *ctx, T_joystick_timeFp timeSource );
+
+/**
+ * @brief Instance variant of joystick_sampleBatch()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSampleBatch( T_joystick_ctx *ctx, T_joystick_record *buf, uint8_t n, uint32_t periodUs );
+
+/**
+ * @brief Instance variant of joystick_setButtonTiming()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetButtonTiming( T_joystick_ctx *ctx, uint16_t tickUs, uint8_t debounceTicks, uint16_t longPressTicks, uint16_t doubleClickTicks );
+
+/**
+ * @brief Instance variant of joystick_buttonTick()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxButtonTick( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_buttonBusy()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxButtonBusy( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_getButtonState()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetButtonState( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_popButtonEvent()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxPopButtonEvent( T_joystick_ctx *ctx, T_joystick_buttonEvent *event );
+
+/**
+ * @brief Instance variant of joystick_getDroppedButtonEvents()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxGetDroppedButtonEvents( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_setAdaptiveRate()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetAdaptiveRate( T_joystick_ctx *ctx, uint16_t minPeriod, uint16_t maxPeriod, uint8_t deltaThreshold, uint8_t idleSamples );
+
+/**
+ * @brief Instance variant of joystick_setRateAlignment()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxSetRateAlignment( T_joystick_ctx *ctx, uint8_t enable );
+
+/**
+ * @brief Instance variant of joystick_updateRate()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint16_t joystick_ctxUpdateRate( T_joystick_ctx *ctx, int8_t ox, int8_t oy );
+
+#ifdef __JOYSTICK_STATS__
+/**
+ * @brief Instance variant of joystick_getStats()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxGetStats( T_joystick_ctx *ctx, T_joystick_stats *stats );
+
+/**
+ * @brief Instance variant of joystick_resetStats()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxResetStats( T_joystick_ctx *ctx );
+#endif
+
+#ifdef __JOYSTICK_TELEMETRY__
+/**
+ * @brief Instance variant of joystick_telemetryReset()
+ *
+ * @param[in] ctx                            driver instance
+ */
+void joystick_ctxTelemetryReset( T_joystick_ctx *ctx );
+
+/**
+ * @brief Instance variant of joystick_telemetryEncode()
+ *
+ * @param[in] ctx                            driver instance
+ */
+uint8_t joystick_ctxTelemetryEncode( T_joystick_ctx *ctx, T_joystick_record *record, uint8_t *frame );
+#endif
+
 
 
 
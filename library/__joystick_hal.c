@@ -41,6 +41,17 @@
 #define T_HAL_UART_OBJ  const T_hal_uartObj*
 #define T_HAL_GPIO_OBJ  const T_hal_gpioObj*
 
+/**
+ * Storage class of the HAL mapping state. With __HAL_THREADS__ ( host
+ * builds ) every thread keeps its own mapped bus and pins, so threads
+ * driving different buses do not remap each other.
+ */
+#ifdef __HAL_THREADS__
+#define HAL_TLS         __thread
+#else
+#define HAL_TLS
+#endif
+
 /** @defgroup JOYSTICK_HAL_COMPILE HAL Cofiguration */            /** @{ */
 
 //                #define   __HAL_SPI__                            /**<     @macro __HAL_SPI__  @brief SPI HAL selector */                
@@ -73,6 +84,14 @@
 // #define   __SCL_PIN_OUTPUT__        10                                    
 // #define   __SDA_PIN_OUTPUT__        11    
                                                                        /** @} */
+#ifdef __HAL_TRACE__
+/* Map and bus functions of the platform HAL are wrapped by the capture layer in __HAL_TRACE.c */
+#define hal_i2cMap      hal_traceLowerI2cMap
+#define hal_i2cStart    hal_traceLowerI2cStart
+#define hal_i2cWrite    hal_traceLowerI2cWrite
+#define hal_i2cRead     hal_traceLowerI2cRead
+#define hal_gpioMap     hal_traceLowerGpioMap
+#endif
 #ifdef __HAL_SPI__
 
 /** @defgroup JOYSTICK_HAL_SPI HAL SPI Interface */               /** @{ */
@@ -243,76 +262,76 @@ typedef struct
 }T_hal_gpioObj;
 
 #ifdef __AN_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_anGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_anGet; 
 #endif
 #ifdef __CS_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_csGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_csGet; 
 #endif
 #ifdef __RST_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_rstGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_rstGet; 
 #endif
 #ifdef __SCK_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_sckGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_sckGet; 
 #endif
 #ifdef __MISO_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_misoGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_misoGet; 
 #endif
 #ifdef __MOSI_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_mosiGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_mosiGet; 
 #endif
 #ifdef __PWM_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_pwmGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_pwmGet; 
 #endif
 #ifdef __INT_PIN_INPUT__
-static T_hal_gpioGetFp          hal_gpio_intGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_intGet; 
 #endif
 #ifdef __RX_PIN_INPUT__   
-static T_hal_gpioGetFp          hal_gpio_rxGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_rxGet; 
 #endif
 #ifdef __TX_PIN_INPUT__   
-static T_hal_gpioGetFp          hal_gpio_txGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_txGet; 
 #endif
 #ifdef __SCL_PIN_INPUT__  
-static T_hal_gpioGetFp          hal_gpio_sclGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_sclGet; 
 #endif
 #ifdef __SDA_PIN_INPUT__  
-static T_hal_gpioGetFp          hal_gpio_sdaGet; 
+static HAL_TLS T_hal_gpioGetFp          hal_gpio_sdaGet; 
 #endif
 #ifdef __AN_PIN_OUTPUT__  
-static T_hal_gpioSetFp          hal_gpio_anSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_anSet;  
 #endif
 #ifdef __CS_PIN_OUTPUT__
-static T_hal_gpioSetFp          hal_gpio_csSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_csSet;  
 #endif
 #ifdef __RST_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_rstSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_rstSet;  
 #endif
 #ifdef __SCK_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_sckSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_sckSet;  
 #endif
 #ifdef __MISO_PIN_OUTPUT__
-static T_hal_gpioSetFp          hal_gpio_misoSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_misoSet;  
 #endif
 #ifdef __MOSI_PIN_OUTPUT__
-static T_hal_gpioSetFp          hal_gpio_mosiSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_mosiSet;  
 #endif
 #ifdef __PWM_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_pwmSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_pwmSet;  
 #endif
 #ifdef __INT_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_intSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_intSet;  
 #endif
 #ifdef __RX_PIN_OUTPUT__  
-static T_hal_gpioSetFp          hal_gpio_rxSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_rxSet;  
 #endif
 #ifdef __TX_PIN_OUTPUT__  
-static T_hal_gpioSetFp          hal_gpio_txSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_txSet;  
 #endif
 #ifdef __SCL_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_sclSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_sclSet;  
 #endif
 #ifdef __SDA_PIN_OUTPUT__ 
-static T_hal_gpioSetFp          hal_gpio_sdaSet;  
+static HAL_TLS T_hal_gpioSetFp          hal_gpio_sdaSet;  
 #endif                              
 
 /**
@@ -396,6 +415,18 @@ static void hal_gpioMap(T_HAL_P gpioObj)
 #endif
 }
                                                                        /** @} */
+#ifdef __HAL_HOST_SIM__
+#include "__HAL_SIM.c"
+#endif
+
+#ifdef __HAL_LINUX__
+#include "__HAL_LINUX.c"
+#endif
+
+#ifdef __HAL_REPLAY__
+#include "__HAL_TRACE.c"
+#endif
+
 #ifdef __MIKROC_PRO_FOR_PIC__
 #include "__HAL_PIC.c"
 #endif
@@ -448,6 +479,10 @@ static void hal_gpioMap(T_HAL_P gpioObj)
 #endif
 #endif
 
+#ifdef __HAL_TRACE__
+#include "__HAL_TRACE.c"
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*
   __joystick_hal.c